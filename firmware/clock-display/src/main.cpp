@@ -4,11 +4,11 @@
 #include "i2c-slave.hpp"
 #include "protocol.hpp"
 #include "light-sensor.hpp"
+#include "framing.hpp"
 
 #include <avr/io.h>
 #include <avr/wdt.h>
 #include <avr/interrupt.h>
-#include <util/crc16.h>
 
 constexpr bool WATCHDOG_ENABLE = true;
 constexpr bool VERIFY_INPUT_I2C_COMMANDS_CRC8 = true;
@@ -16,136 +16,124 @@ constexpr bool VERIFY_INPUT_I2C_COMMANDS_CRC8 = true;
 
 using namespace octoglow::vfd_clock;
 using namespace octoglow::vfd_clock::protocol;
+using namespace octoglow;
 
+/*
+ * Command received last. Write commands are executed right away, commands responding with data
+ * when the reply buffer can be written.
+ */
 static auto currentCommand = Command::NONE;
 
 /**
- *
- * @param dataPayloadLength We include command byte and the following payload. Payload length can be 0, in this case only command byte is taken to the calculation.
+ * @param message CRC followed by the command byte and its payload
+ * @param messageLength number of bytes of the message, CRC included
  * @return if CRC calculated locally matches the sent one via I2C
  */
-static bool checkCrc8(const uint8_t dataPayloadLength) {
+static bool checkCrc8(const uint8_t *const message, const uint8_t messageLength) {
     if constexpr (!VERIFY_INPUT_I2C_COMMANDS_CRC8) {
         return true;
     }
 
-    uint8_t calculatedCrcValue = 0;
-    for (uint8_t i = 1; i < dataPayloadLength + 2; ++i) {
-        calculatedCrcValue = _crc8_ccitt_update(calculatedCrcValue, i2c_wrbuf[i]);
-    }
-    return i2c_wrbuf[0] == calculatedCrcValue;
+    return message[0] == framing::crc8(message + 1, messageLength - 1);
+}
+
+static void setDisplayContent(const uint8_t *const frame, uint8_t *) {
+    const auto *dc = reinterpret_cast<const DisplayContent *>(frame + 1);
+    display::setDots(dc->dotState, false);
+    display::setAllCharacters(dc->characters);
 }
 
-// __attribute__((optimize("O3"), hot))
-static inline void setCrcForSimpleCommand() {
-    i2c_rdbuf[0] = _crc8_ccitt_update(0, i2c_rdbuf[1]);
-    i2c_reply_done(2);
+static void setRelay(const uint8_t *const frame, uint8_t *) {
+    const auto *rs = reinterpret_cast<const RelayState *>(frame + 1);
+    relay::setState(relay::Relay::RELAY_1, rs->relay1enabled);
+    relay::setState(relay::Relay::RELAY_2, rs->relay2enabled);
 }
 
-// __attribute__((optimize("O3"), hot))
-static inline void setCrcForComplexCommand(const uint8_t payloadLength) {
-    uint8_t crcValue = 0;
-    for (uint8_t i = 1; i < payloadLength + 2; ++i) {
-        crcValue = _crc8_ccitt_update(crcValue, i2c_rdbuf[i]);
+static void setBrightness(const uint8_t *const frame, uint8_t *) {
+    display::setBrightness(frame[1]);
+}
+
+static void getWeatherSensorState(const uint8_t *, uint8_t *const response) {
+    for (uint8_t i = 0; i != sizeof(WeatherSensorState); ++i) {
+        response[i] = reinterpret_cast<uint8_t *>(&receiver433::currentWeatherSensorState)[i];
     }
-    i2c_rdbuf[0] = crcValue;
-    i2c_reply_done(payloadLength + 2);
+    receiver433::currentWeatherSensorState.flags |= ALREADY_READ_FLAG;
+}
+
+static void getLightSensorValue(const uint8_t *, uint8_t *const response) {
+    const uint16_t measurement = lightsensor::getMeasurement();
+    response[0] = 0xff & measurement;
+    response[1] = 0xff & (measurement >> 8);
 }
 
+/**
+ * Commands with response length 0 respond only with the command number. The frame of the commands
+ * responding with data is no longer available when their handlers are called.
+ */
+static constexpr framing::CommandDescriptor COMMANDS[] FRAMING_TABLE = {
+        framing::fixed(Command::SET_DISPLAY_CONTENT, 1 + sizeof(DisplayContent), setDisplayContent),
+        framing::fixed(Command::SET_RELAY, 1 + sizeof(RelayState), setRelay),
+        framing::fixed(Command::SET_BRIGHTNESS, 2, setBrightness),
+        framing::fixed(Command::GET_WEATHER_SENSOR_STATE, 1, getWeatherSensorState, sizeof(WeatherSensorState)),
+        framing::fixed(Command::GET_LIGHT_SENSOR_VALUE, 1, getLightSensorValue, sizeof(uint16_t)),
+};
+
+static_assert(framing::isValidTable(COMMANDS), "commands have to be listed in the order of their numbers");
+
 static inline void processI2cReadCommands() {
-    if (!i2c_reply_ready()) {
+    framing::CommandDescriptor descriptor{};
+    if (not framing::findCommand(COMMANDS, static_cast<uint8_t>(currentCommand), descriptor)
+        or !i2c_reply_ready()) {
         return;
     }
 
-    using namespace octoglow::vfd_clock::protocol;
-
-    i2c_rdbuf[1] = i2c_wrbuf[1];
-
     static_assert(sizeof(WeatherSensorState) + 2 <= sizeof(i2c_rdbuf));
 
-    switch (currentCommand) {
-        case Command::GET_WEATHER_SENSOR_STATE: {
-            for (uint8_t i = sizeof(WeatherSensorState) + 1; i != 1; --i) {
-                i2c_rdbuf[i] = reinterpret_cast<uint8_t *>(&receiver433::currentWeatherSensorState)[i - 2];
-            }
-            receiver433::currentWeatherSensorState.flags |= ALREADY_READ_FLAG;
-            setCrcForComplexCommand(sizeof(WeatherSensorState));
-            break;
-        }
-        case Command::GET_LIGHT_SENSOR_VALUE: {
-            const uint16_t measurement = lightsensor::getMeasurement();
-            i2c_rdbuf[2] = 0xff & measurement;
-            i2c_rdbuf[3] = 0xff & (measurement >> 8);
-            setCrcForComplexCommand(2);
-            break;
-        }
-        case Command::SET_BRIGHTNESS:
-        case Command::SET_RELAY:
-        case Command::SET_DISPLAY_CONTENT: {
-            setCrcForSimpleCommand();
-            break;
-        }
-        default:
-            break;
+    uint8_t response[sizeof(i2c_rdbuf)];
+    response[1] = descriptor.command;
+    if (descriptor.responseLength != 0) {
+        descriptor.handler(nullptr, &response[2]);
+    }
+
+    const uint8_t responseLength = framing::sealResponse(response, descriptor.responseLength);
+    for (uint8_t i = 0; i != responseLength; ++i) {
+        i2c_rdbuf[i] = response[i];
     }
+    i2c_reply_done(responseLength);
 
     currentCommand = Command::NONE;
 }
 
 static inline void processI2cWriteCommands() {
-    if (!i2c_message_ready()) {
+    const uint8_t messageLength = i2c_message_ready();
+    if (!messageLength) {
         return;
     }
 
     static_assert(sizeof(DisplayContent) + 2 <= sizeof(i2c_wrbuf));
     static_assert(sizeof(RelayState) + 2 <= sizeof(i2c_wrbuf));
 
-    switch (static_cast<Command>(i2c_wrbuf[1])) {
-        case Command::SET_DISPLAY_CONTENT: {
-            if (!checkCrc8(sizeof(DisplayContent))) {
-                break;
-            }
-            const auto *dc = reinterpret_cast<volatile DisplayContent *>(&i2c_wrbuf[2]);
-            display::setDots(dc->dotState, false);
-            display::setAllCharacters(dc->characters);
-            currentCommand = Command::SET_DISPLAY_CONTENT;
-        }
-        break;
-        case Command::SET_RELAY: {
-            if (!checkCrc8(sizeof(RelayState))) {
-                break;
-            }
-            const auto *rs = reinterpret_cast<volatile RelayState *>(&i2c_wrbuf[2]);
-            relay::setState(relay::Relay::RELAY_1, rs->relay1enabled);
-            relay::setState(relay::Relay::RELAY_2, rs->relay2enabled);
-            currentCommand = Command::SET_RELAY;
-        }
-        break;
-        case Command::SET_BRIGHTNESS:
-            if (!checkCrc8(1)) {
-                break;
-            }
-            display::setBrightness(i2c_wrbuf[2]);
-            currentCommand = Command::SET_BRIGHTNESS;
-            break;
-        case Command::GET_WEATHER_SENSOR_STATE:
-            if (!checkCrc8(0)) {
-                break;
-            }
-            currentCommand = Command::GET_WEATHER_SENSOR_STATE;
-            break;
-        case Command::GET_LIGHT_SENSOR_VALUE:
-            if (!checkCrc8(0)) {
-                break;
-            }
-            currentCommand = Command::GET_LIGHT_SENSOR_VALUE;
-            break;
-        default:
-            currentCommand = Command::NONE;
-            break;
+    uint8_t message[sizeof(i2c_wrbuf)];
+    for (uint8_t i = 0; i != messageLength; ++i) {
+        message[i] = i2c_wrbuf[i];
     }
-
     i2c_message_done();
+
+    framing::CommandDescriptor descriptor{};
+    currentCommand = Command::NONE;
+
+    // crc is at 0, command is at 1
+    if (messageLength < 2
+        or not framing::findCommand(COMMANDS, message[1], descriptor)
+        or not framing::isFrameComplete(descriptor, &message[1], messageLength - 1)
+        or not checkCrc8(message, messageLength)) {
+        return;
+    }
+
+    if (descriptor.responseLength == 0) {
+        descriptor.handler(&message[1], nullptr);
+    }
+    currentCommand = static_cast<Command>(descriptor.command);
 }
 
 [[noreturn]] int main() {
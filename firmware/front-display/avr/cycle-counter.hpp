@@ -0,0 +1,19 @@
+#pragma once
+
+#include <avr/io.h>
+#include <inttypes.h>
+
+/**
+ * Timer 1 runs at F_CPU and restarts every grid, so it measures the time spent in short interrupt bodies.
+ */
+static inline uint16_t cycleCounter() {
+    return TCNT1;
+}
+
+/**
+ * @return number of CPU cycles elapsed since startCycle, the interval has to be shorter than a single grid
+ */
+static inline uint16_t cyclesSince(const uint16_t startCycle) {
+    const uint16_t endCycle = cycleCounter();
+    return endCycle >= startCycle ? endCycle - startCycle : endCycle + OCR1A + 1 - startCycle;
+}
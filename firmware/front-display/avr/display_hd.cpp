@@ -2,6 +2,9 @@
 #include "display.hpp"
 #include "main.hpp"
 
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
 #define CK_PORT D
 #define CK_PIN 7
 
@@ -20,8 +23,65 @@
 using namespace octoglow::front_display::display;
 using namespace octoglow::front_display::display::hd;
 
+constexpr uint8_t REFRESH_TIMER_PRESCALER = 1;
+constexpr uint32_t REFRESH_TIMER_PERIOD = F_CPU / REFRESH_TIMER_PRESCALER / (FRAME_RATE * NUM_OF_CHARACTERS);
+
+static_assert(REFRESH_TIMER_PERIOD <= 0xffff, "frame rate too low for 16-bit timer");
+// building and shifting out a single grid takes about 1800 CPU cycles, leave time for the main loop and other interrupts
+static_assert(REFRESH_TIMER_PERIOD * REFRESH_TIMER_PRESCALER >= 3000, "frame rate too high");
+
+/**
+ * All grids are blanked for at least this time between the end of the on-time and the next grid,
+ * the new grid is latched then.
+ */
+constexpr uint16_t BLANKING_TIME = F_CPU / REFRESH_TIMER_PRESCALER / 250000; // 4 us
+constexpr uint16_t MAX_ON_TIME = REFRESH_TIMER_PERIOD - BLANKING_TIME;
+
+/*
+ * Relative luminance for the given lightness, CIE 1931.
+ */
+static constexpr double cieLuminance(const double lightness) {
+    if (lightness <= 8.0) {
+        return lightness / 903.3;
+    }
+    const double l = (lightness + 16.0) / 116.0;
+    return l * l * l;
+}
+
+struct OnTimeTable {
+    uint16_t ticks[MAX_FINE_BRIGHTNESS + 1];
+
+    constexpr OnTimeTable() : ticks() {
+        for (uint8_t level = 1; level <= MAX_FINE_BRIGHTNESS; ++level) {
+            const double luminance = cieLuminance(100.0 * level / MAX_FINE_BRIGHTNESS);
+            auto t = static_cast<uint16_t>(luminance * MAX_ON_TIME + 0.5);
+
+            // every level has to be distinguishable
+            if (t <= ticks[level - 1]) {
+                t = ticks[level - 1] + 1;
+            }
+            ticks[level] = t;
+        }
+    }
+};
+
+/**
+ * Timer 1 ticks the grid is lit for each brightness level, gamma-corrected.
+ */
+static const OnTimeTable onTimeTable PROGMEM = OnTimeTable();
+
+static_assert(OnTimeTable().ticks[MAX_FINE_BRIGHTNESS] == MAX_ON_TIME);
+
 static uint8_t currentPosition = 0;
 
+/**
+ * Brightness level of the grid shifted in, set when it is latched. It is lowered for the dimmed characters.
+ */
+static uint8_t shiftedGridBrightness = 0;
+
+static uint8_t blinkFrames = 0;
+static bool blinkedOff = false;
+
 void octoglow::front_display::display::init() {
     // all connectors are outputs
     DDR(CK_PORT) |= _BV(CK_PIN);
@@ -29,6 +89,17 @@ void octoglow::front_display::display::init() {
     DDR(CL_PORT) |= _BV(CL_PIN);
     DDR(STB_PORT) |= _BV(STB_PIN);
     DDR(S_IN_PORT) |= _BV(S_IN_PIN);
+
+    /*
+     * Timer 1 in fast PWM mode with TOP in OCR1A, no prescaler. The period is the time of a single grid.
+     * CL is wired to OC1B, so it is set at BOTTOM and cleared by the compare match, which ends the grid's
+     * on-time without any code involved. The interrupt on the same compare match latches the next grid.
+     */
+    TCCR1A = _BV(WGM11) | _BV(WGM10);
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10);
+    OCR1A = REFRESH_TIMER_PERIOD - 1;
+    OCR1B = MAX_ON_TIME - 1;
+    TIMSK1 |= _BV(OCIE1B);
 }
 
 static inline __attribute((always_inline)) void ckPulse() {
@@ -36,193 +107,109 @@ static inline __attribute((always_inline)) void ckPulse() {
     PORT(CK_PORT) |= _BV(CK_PIN);
 }
 
-static inline void iterateOverPositionsAscending(const uint8_t startInclusive,
-                                                 const uint8_t stopInclusive,
-                                                 const uint8_t validPosition) {
-    for (uint8_t p = startInclusive; p != stopInclusive + 1; ++p) {
-        PORT(CK_PORT) &= ~_BV(CK_PIN);
-        if (p == validPosition) {
-            PORT(S_IN_PORT) |= _BV(S_IN_PIN);
-        } else {
-            PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-        }
-        PORT(CK_PORT) |= _BV(CK_PIN);
-    }
-}
-
-static void iterateOverPositionsDescending(const uint8_t startInclusive,
-                                           const uint8_t stopInclusive,
-                                           const uint8_t validPosition) {
-    const uint8_t span = startInclusive - stopInclusive + 1;
-    const uint8_t match = validPosition - stopInclusive + 1;
-
-    for (uint8_t p = span; p != 0; --p) {
-        PORT(CK_PORT) &= ~_BV(CK_PIN);
-        if (p == match) {
-            PORT(S_IN_PORT) |= _BV(S_IN_PIN);
-        } else {
-            PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-        }
-        PORT(CK_PORT) |= _BV(CK_PIN);
-    }
-}
-
-static inline __attribute((always_inline)) void setOutputPin(const uint8_t *characterBuffer, const int8_t column,
-                                                             const int8_t row) {
-    if (const uint8_t go = characterBuffer[column]; go & (1 << row)) {
-        PORT(S_IN_PORT) |= _BV(S_IN_PIN);
-    } else {
-        PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-    }
-}
-
-//__attribute__((optimize("unroll-loops")))
-static inline void __attribute__((optimize("O3"), hot, always_inline)) holdCharacterOnDisplayInputs(uint8_t position) {
-    PORT(STB_PORT) &= ~_BV(STB_PIN);
-
-    if (_brightness == 0) {
-        PORT(CL_PORT) &= ~_BV(CL_PIN);
-    } else {
-        PORT(CL_PORT) |= _BV(CL_PIN);
-    }
-
-    const uint8_t *characterPtr = &_frameBuffer[(COLUMNS_IN_CHARACTER * position) % (
-                                                    NUM_OF_CHARACTERS * COLUMNS_IN_CHARACTER)];
-
+/**
+ * Returns the index of the grid bit in the 40-bit grid part of the scan chain. First 20 bits are shifted
+ * before the anodes, the remaining ones after. The tube is wired in a different order than the characters.
+ */
+static constexpr uint8_t gridBitIndex(uint8_t position) {
     if ((position >= 10) and (position <= 19)) {
         position += 20;
-    } else if ((position >= 20) and (position <= 29)) {
+    } else if (position >= 20) {
         position -= 10;
-    } else if (position >= 30) {
-        position -= 10;
-    }
-
-    if (_brightness == 1) {
-        PORT(CL_PORT) &= ~_BV(CL_PIN);
     }
 
-    if (position < 20) {
+    if (position <= 6) {
         // g7 - g1
-        iterateOverPositionsDescending(6, 0, position);
-
-        // g8 - g20
-        iterateOverPositionsAscending(7, 19, position);
+        return 6 - position;
+    } else if (position <= 32) {
+        // g8 - g20, g21 - g33
+        return position;
     } else {
-        PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-        for (uint8_t i = 0; i != 20; ++i) {
-            ckPulse();
-        }
-    }
-
-    if (_brightness == 2) {
-        PORT(CL_PORT) &= ~_BV(CL_PIN);
+        // g40 - g34
+        return 72 - position;
     }
+}
 
-    // a1 - a11
-    int8_t column = 2;
-    int8_t row = 3;
-    for (uint8_t a = 0; a != 11; ++a) {
-        setOutputPin(characterPtr, column, row);
-
-        ++column;
+struct GridBitIndexTable {
+    uint8_t index[NUM_OF_CHARACTERS];
 
-        if (column == 5) {
-            column = 0;
-            ++row;
+    constexpr GridBitIndexTable() : index() {
+        for (uint8_t p = 0; p != NUM_OF_CHARACTERS; ++p) {
+            index[p] = gridBitIndex(p);
         }
-
-        ckPulse();
-    }
-
-    column = 4;
-    row = 6;
-    // a18 - a14
-    for (uint8_t a = 17; a != 12; --a) {
-        setOutputPin(characterPtr, column, row);
-        --column;
-        ckPulse();
-    }
-
-    // 2 dummy
-    PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-    ckPulse();
-    ckPulse();
-
-    if (_brightness == 3) {
-        PORT(CL_PORT) &= ~_BV(CL_PIN);
     }
+};
 
-    // a12 - a13
-    setOutputPin(characterPtr, 3, 5);
-    ckPulse();
-    setOutputPin(characterPtr, 4, 5);
-    ckPulse();
+static const GridBitIndexTable gridBitIndexTable PROGMEM = GridBitIndexTable();
 
-
-    // 2 dummy
-    PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-    ckPulse();
-    ckPulse();
-
-    // a25 - a19
-    column = 0;
-    row = 2;
-    for (uint8_t a = 24; a != 17; --a) {
-        setOutputPin(characterPtr, column, row);
-
-        if (column == 4) {
-            column = 0;
-            ++row;
+static inline __attribute((always_inline)) void shiftOutGridBits(const uint8_t start, const uint8_t gridBit) {
+    for (uint8_t i = start; i != start + 20; ++i) {
+        if (i == gridBit) {
+            PORT(S_IN_PORT) |= _BV(S_IN_PIN);
         } else {
-            ++column;
+            PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
         }
-
         ckPulse();
     }
+}
 
-    // a26 - a35
-    column = 4;
-    row = 1;
-    for (uint8_t a = 25; a != 35; ++a) {
-        setOutputPin(characterPtr, column, row);
-
-        if (column == 0) {
-            column = 4;
-            --row;
+static inline __attribute((always_inline)) void shiftOutByte(uint8_t value) {
+    for (uint8_t b = 0; b != 8; ++b) {
+        if (value & 0x80) {
+            PORT(S_IN_PORT) |= _BV(S_IN_PIN);
         } else {
-            --column;
+            PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
         }
-
         ckPulse();
+        value <<= 1;
     }
+}
 
-    if (_brightness == 4) {
-        PORT(CL_PORT) &= ~_BV(CL_PIN);
-    }
+static inline __attribute((always_inline)) void latchShiftedGrid() {
+    PORT(STB_PORT) |= _BV(STB_PIN);
+    PORT(STB_PORT) &= ~_BV(STB_PIN);
+}
 
-    // a36 - upper bar
-    if ((position < 10 and _upperBarBuffer & (1L << position))
-        or (position >= 30 and position < 40 and _upperBarBuffer & (1L << (position - 20)))) {
-        PORT(S_IN_PORT) |= _BV(S_IN_PIN);
+/**
+ * Sets the on-time of the grid which is going to be displayed from the next timer period.
+ */
+static inline __attribute((always_inline)) void setOnTime(const uint8_t brightness) {
+    if (brightness == 0) {
+        // OC1B cannot be kept low in fast PWM mode, disconnect it
+        TCCR1A = _BV(WGM11) | _BV(WGM10);
+        PORT(CL_PORT) &= ~_BV(CL_PIN);
     } else {
-        PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
+        TCCR1A = _BV(COM1B1) | _BV(WGM11) | _BV(WGM10);
+        OCR1B = pgm_read_word(&onTimeTable.ticks[brightness]) - 1;
     }
-    ckPulse();
+}
 
-    if (position > 19) {
-        // g21 - g33
-        iterateOverPositionsAscending(20, 32, position);
+/**
+ * Shifts the grid into the driver chain. It is not displayed until it is latched.
+ */
+static inline void __attribute__((optimize("O3"), hot, always_inline)) holdCharacterOnDisplayInputs(const uint8_t position) {
+    const uint8_t gridBit = pgm_read_byte(&gridBitIndexTable.index[position]);
+    uint8_t image[WIRE_IMAGE_BYTES_PER_GRID];
+    _buildGridImage(position, image);
 
-        // g40 - g34
-        iterateOverPositionsDescending(39, 33, position);
-    } else {
-        PORT(S_IN_PORT) &= ~_BV(S_IN_PIN);
-        for (uint8_t i = 0; i != 20; ++i) {
-            ckPulse();
-        }
+    // the attributes change only the dot bits, the upper bar segment is left as it is
+    const uint8_t invertedDots = _isCellInSet(_invertedCells, position) ? 0xff : 0;
+    const uint8_t blankedDots = (blinkedOff and _isCellInSet(_blinkingCells, position)) ? 0xff : 0;
+
+    // fine brightness levels are perceptually spaced, the dimmed character is lit at half the level
+    shiftedGridBrightness = _isCellInSet(_dimmedCells, position) ? (_brightness + 1) / 2 : _brightness;
+
+    // g7 - g1, g8 - g20
+    shiftOutGridBits(0, gridBit);
+
+    // a1 - a11, a18 - a14, 2 dummy, a12 - a13, 2 dummy, a25 - a19, a26 - a35, a36 - upper bar
+    for (uint8_t i = 0; i != WIRE_IMAGE_BYTES_PER_GRID; ++i) {
+        const uint8_t dotMask = wireImageDotMask(i);
+        shiftOutByte((image[i] ^ (invertedDots & dotMask)) & ~(blankedDots & dotMask));
     }
 
-    PORT(STB_PORT) |= _BV(STB_PIN);
+    // g21 - g33, g40 - g34
+    shiftOutGridBits(20, gridBit);
 }
 
 
@@ -231,7 +218,36 @@ void hd::displayPool() {
 
     if (currentPosition == NUM_OF_CHARACTERS - 1) {
         currentPosition = 0;
+
+        if (++blinkFrames == BLINK_HALF_PERIOD) {
+            blinkFrames = 0;
+            blinkedOff = not blinkedOff;
+        }
+
+        // runs with interrupts enabled, the input sampling interrupt reads the counter
+        ATOMIC_BLOCK(ATOMIC_FORCEON) {
+            _frameTicks = _frameTicks + 1;
+        }
     } else {
         ++currentPosition;
     }
 }
+
+/*
+ * Called when the on-time of the current grid has ended. The grid shifted in the previous call is latched
+ * while the display is blank, then the next one is shifted in with interrupts enabled, so it doesn't delay
+ * TWI and encoder handling. Its own interrupt is masked meanwhile, so it cannot nest if it gets preempted
+ * for longer than the grid period.
+ */
+ISR(TIMER1_COMPB_vect) {
+    latchShiftedGrid();
+    setOnTime(shiftedGridBrightness);
+
+    TIMSK1 &= ~_BV(OCIE1B);
+    sei();
+
+    displayPool();
+
+    cli();
+    TIMSK1 |= _BV(OCIE1B);
+}
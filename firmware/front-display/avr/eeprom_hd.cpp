@@ -2,15 +2,65 @@
 #include "main.hpp"
 
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+using namespace octoglow::front_display::eeprom;
 
 constexpr uint8_t EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS = 10;
 
+static_assert(EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS < PAGE_STORE_ADDRESS, "page store overlaps the settings");
+static_assert(SIZE == E2END + 1, "invalid EEPROM size");
+
 uint8_t octoglow::front_display::eeprom::readEndYearOfConstruction() {
-    return eeprom_read_byte(reinterpret_cast<uint8_t *>(EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS));
+    return readByte(EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS);
 }
 
 void octoglow::front_display::eeprom::saveEndYearOfConstruction(const uint8_t year) {
-    if (const uint8_t oldYear = readEndYearOfConstruction(); year != oldYear) {
-        eeprom_write_byte(reinterpret_cast<uint8_t *>(EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS), year);
+    updateByte(EEPROM_END_YEAR_OF_CONSTRUCTION_ADDRESS, year);
+}
+
+uint8_t octoglow::front_display::eeprom::hd::read(const uint16_t address) {
+    while (true) {
+        wdt_reset();
+        eeprom_busy_wait();
+
+        // the ready interrupt could start the next write between the check and the read
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (eeprom_is_ready()) {
+                return eeprom_read_byte(reinterpret_cast<const uint8_t *>(address));
+            }
+        }
     }
 }
+
+uint8_t octoglow::front_display::eeprom::hd::readWhenReady(const uint16_t address) {
+    EEAR = address;
+    EECR |= _BV(EERE);
+    return EEDR;
+}
+
+void octoglow::front_display::eeprom::hd::write(const uint16_t address, const uint8_t value) {
+    EEAR = address;
+    EEDR = value;
+    EECR |= _BV(EEMPE);
+    EECR |= _BV(EEPE);
+}
+
+void octoglow::front_display::eeprom::hd::enableReadyInterrupt() {
+    EECR |= _BV(EERIE);
+}
+
+void octoglow::front_display::eeprom::hd::disableReadyInterrupt() {
+    EECR &= ~_BV(EERIE);
+}
+
+void octoglow::front_display::eeprom::hd::waitForWrite() {
+    wdt_reset();
+    eeprom_busy_wait();
+}
+
+ISR(EE_READY_vect) {
+    onReady();
+}
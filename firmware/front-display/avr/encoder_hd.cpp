@@ -1,6 +1,7 @@
 #include "encoder.hpp"
 
 #include "main.hpp"
+#include "cycle-counter.hpp"
 
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
@@ -13,6 +14,9 @@
 #define ENC_B_PIN 2
 #define ENC_BTN_PIN 3
 
+#define EVENT_PENDING_PORT D
+#define EVENT_PENDING_PIN 5
+
 /*
  The encoder: PEC11H-4120F-S0020.
  Datasheet: https://www.bourns.com/docs/product-datasheets/pec11h.pdf
@@ -26,20 +30,46 @@
  */
 
 using namespace octoglow::front_display::encoder;
+using namespace octoglow::front_display;
+
+/*
+ Input sampling engine. Timer 0 samples the encoder and the button at SAMPLE_RATE. The quadrature goes through
+ the ttable state machine, which rejects the contact bounce, the button is debounced by integration.
+ When all inputs have been stable for IDLE_SAMPLES, the timer interrupt is switched off and a pin change
+ only wakes the sampling up again. So the interrupt rate never exceeds MAX_INTERRUPTS_PER_SECOND,
+ no matter how the inputs bounce.
+ */
+constexpr uint16_t SAMPLE_RATE = 2000; // Hz
+constexpr uint8_t TIMER_PRESCALER = 64;
+constexpr uint8_t DEBOUNCE_SAMPLES = 20 * SAMPLE_RATE / 1000;
+constexpr uint8_t IDLE_SAMPLES = 64;
+constexpr uint16_t LONG_PRESS_SAMPLES = LONG_PRESS_TIME * (SAMPLE_RATE / 1000);
+
+constexpr uint16_t MAX_INTERRUPTS_PER_SECOND = SAMPLE_RATE + SAMPLE_RATE / IDLE_SAMPLES;
+
+static_assert(F_CPU / TIMER_PRESCALER / SAMPLE_RATE - 1 <= 0xff, "sample rate too low for 8-bit timer");
+static_assert(MAX_INTERRUPTS_PER_SECOND <= 2100, "input interrupt load too high");
 
-constexpr uint8_t DEBOUNCE_ITERATIONS = 20;
-constexpr uint16_t TICK_FREQUENCY = 1000; // Hz
+constexpr uint8_t INPUT_PINS = _BV(ENC_A_PIN) | _BV(ENC_B_PIN) | _BV(ENC_BTN_PIN);
+
+static inline uint8_t readInputPins() {
+    return PIN(ENC_PORT) & INPUT_PINS;
+}
 
 void octoglow::front_display::encoder::init() {
     // enable pull-up for the button, not for the encoder
     PORT(ENC_PORT) |= _BV(ENC_BTN_PIN);
 
+    // high while there are events waiting to be read
+    DDR(EVENT_PENDING_PORT) |= _BV(EVENT_PENDING_PIN);
+
+    // pin changes only wake the sampling up, the mask is set when it goes idle
+    PCMSK2 = 0;
     PCICR |= _BV(PCIE2);
-    PCMSK2 |= _BV(PCINT18) | _BV(PCINT17);
 
     TCCR0A = _BV(WGM01);
     TCCR0B = _BV(CS01) | _BV(CS00); // f_cpu / 64
-    OCR0A = (F_CPU / 64 / TICK_FREQUENCY) - 1;
+    OCR0A = (F_CPU / TIMER_PRESCALER / SAMPLE_RATE) - 1;
     TIMSK0 |= _BV(OCIE0A);
 }
 
@@ -79,46 +109,102 @@ static const uint8_t ttable[7][4] PROGMEM = {
     {R_CCW_NEXT, R_CCW_FINAL, R_CCW_BEGIN, R_START},
 };
 
-static volatile uint8_t state = R_START;
+static uint8_t state = R_START;
+static uint8_t lastPins = INPUT_PINS;
+static bool buttonPressed = false;
+static uint8_t debounceSamples = 0;
+static uint16_t pressedSamples = 0;
+static uint8_t stableSamples = 0;
+
+static volatile InputLoad inputLoad = {0, 0, 0};
+static uint16_t lastLoadFrameTicks = 0;
+
+static inline void accountInterrupt(const uint16_t startCycle) {
+    inputLoad.cycles += cyclesSince(startCycle);
+    inputLoad.interrupts = inputLoad.interrupts + 1;
+}
+
+static inline void enterIdle(const uint8_t sampledPins) {
+    PCMSK2 = _BV(PCINT17) | _BV(PCINT18) | _BV(PCINT19);
+    PCIFR = _BV(PCIF2);
+
+    // a change between the last sample and enabling the wake-up would be missed
+    if (readInputPins() != sampledPins) {
+        PCMSK2 = 0;
+        return;
+    }
+
+    TIMSK0 &= ~_BV(OCIE0A);
+}
 
-// triggered on every pin change
+// wakes the sampling up, at most once per idle period
 ISR(PCINT2_vect) {
-    const uint8_t pinState = ((PIN(ENC_PORT) & (_BV(ENC_A_PIN) | _BV(ENC_B_PIN))) >> 1) & 0b11;
+    const uint16_t startCycle = cycleCounter();
+
+    PCMSK2 = 0;
+    TCNT0 = 0;
+    TIFR0 = _BV(OCF0A);
+    TIMSK0 |= _BV(OCIE0A);
+
+    accountInterrupt(startCycle);
+}
+
+// triggered at SAMPLE_RATE while the inputs are active
+ISR(TIMER0_COMPA_vect) {
+    const uint16_t startCycle = cycleCounter();
+    const uint8_t pins = readInputPins();
 
-    state = pgm_read_byte(&ttable[state & 0xf][pinState]);
+    state = pgm_read_byte(&ttable[state & 0xf][(pins >> ENC_A_PIN) & 0b11]);
     const uint8_t result = state & 0x30;
 
     if (result == DIR_CW) {
         _currentEncoderSteps++;
+        _position++;
+        _pushEvent(EventType::STEP_CW, display::_frameTicks);
     } else if (result == DIR_CCW) {
         _currentEncoderSteps--;
+        _position--;
+        _pushEvent(EventType::STEP_CCW, display::_frameTicks);
     }
-}
-
-static volatile bool prevButtonState = false;
-static volatile uint8_t currentDebounceIterations = 0;
 
-// triggered every 1 ms
-ISR(TIMER0_COMPA_vect) {
-    if (!(PIN(ENC_PORT) & _BV(ENC_BTN_PIN)) and !prevButtonState) {
-        ++currentDebounceIterations;
-
-        if (currentDebounceIterations == DEBOUNCE_ITERATIONS) {
-            currentDebounceIterations = 0;
-            prevButtonState = true;
-            _currentButtonState = ButtonState::JUST_PRESSED;
-        }
-    } else if (PIN(ENC_PORT) & _BV(ENC_BTN_PIN) and prevButtonState) {
-        ++currentDebounceIterations;
-
-        if (currentDebounceIterations == DEBOUNCE_ITERATIONS) {
-            currentDebounceIterations = 0;
-            prevButtonState = false;
-            _currentButtonState = ButtonState::JUST_RELEASED;
+    const bool pressedNow = !(pins & _BV(ENC_BTN_PIN));
+
+    if (pressedNow != buttonPressed) {
+        if (++debounceSamples == DEBOUNCE_SAMPLES) {
+            debounceSamples = 0;
+            buttonPressed = pressedNow;
+
+            if (pressedNow) {
+                pressedSamples = 0;
+                _currentButtonState = ButtonState::JUST_PRESSED;
+                _pushEvent(EventType::BUTTON_PRESSED, display::_frameTicks);
+            } else {
+                _currentButtonState = ButtonState::JUST_RELEASED;
+                _pushEvent(EventType::BUTTON_RELEASED, display::_frameTicks);
+            }
         }
     } else {
-        currentDebounceIterations = 0;
+        debounceSamples = 0;
+    }
+
+    if (buttonPressed and pressedSamples != LONG_PRESS_SAMPLES and ++pressedSamples == LONG_PRESS_SAMPLES) {
+        _pushEvent(EventType::BUTTON_LONG_PRESSED, display::_frameTicks);
+    }
+
+    const bool settled = pins == lastPins
+                         and (state & 0xf) == R_START
+                         and debounceSamples == 0
+                         and (not buttonPressed or pressedSamples == LONG_PRESS_SAMPLES);
+    lastPins = pins;
+
+    if (not settled) {
+        stableSamples = 0;
+    } else if (++stableSamples == IDLE_SAMPLES) {
+        stableSamples = 0;
+        enterIdle(pins);
     }
+
+    accountInterrupt(startCycle);
 }
 
 int8_t octoglow::front_display::encoder::getValueAndClear() {
@@ -130,6 +216,28 @@ int8_t octoglow::front_display::encoder::getValueAndClear() {
     return v;
 }
 
+InputLoad octoglow::front_display::encoder::getInputLoadAndClear() {
+    InputLoad v;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        v.interrupts = inputLoad.interrupts;
+        v.cycles = inputLoad.cycles;
+        v.frames = display::_frameTicks - lastLoadFrameTicks;
+
+        inputLoad.interrupts = 0;
+        inputLoad.cycles = 0;
+        lastLoadFrameTicks = display::_frameTicks;
+    }
+    return v;
+}
+
+void octoglow::front_display::encoder::hd::setEventPending(const bool pending) {
+    if (pending) {
+        PORT(EVENT_PENDING_PORT) |= _BV(EVENT_PENDING_PIN);
+    } else {
+        PORT(EVENT_PENDING_PORT) &= ~_BV(EVENT_PENDING_PIN);
+    }
+}
+
 ButtonState octoglow::front_display::encoder::getButtonStateAndClear() {
     ButtonState v;
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
@@ -1,57 +1,118 @@
 #include "i2c-slave.hpp"
 
+#include "main.hpp"
+#include "cycle-counter.hpp"
+
 #include <avr/io.h>
 #include <util/twi.h>
+#include <util/atomic.h>
 #include <avr/interrupt.h>
-#include <util/crc16.h>
 
 using namespace octoglow::front_display::i2c;
 
+/*
+ The slave is designed for the 400 kHz fast mode. The TWI stretches SCL from the acknowledge of every byte
+ until TWINT is cleared, so the interrupt latency and body are added to each byte time, 9 SCL periods,
+ that is 360 CPU cycles at 400 kHz. The status is read once, every handler has a single call site,
+ so with the link-time optimization they are inlined into the interrupt, and TWCR is written at one place.
+ The cycles spent in the interrupt body are measured with timer 1 and reported by GET_I2C_LOAD only if
+ I2C_LOAD_ACCOUNTING is defined. The accounting adds about 50 cycles to every byte, otherwise NOT_MEASURED_BUS_LOAD
+ is reported.
+ */
+constexpr uint32_t FAST_MODE_SCL_FREQUENCY = 400000;
+
+static_assert(F_CPU >= 16 * FAST_MODE_SCL_FREQUENCY, "TWI slave needs CPU clock at least 16 times the SCL frequency");
+
 /**
- * set the TWCR to enable address matching and enable TWI, clear TWINT, enable TWI interrupt
+ * TWCR value which enables address matching and TWI, clears TWINT and enables the TWI interrupt.
  */
-static void prepareForNextByte() {
-    TWCR = _BV(TWIE) | _BV(TWINT) | _BV(TWEA) | _BV(TWEN);
-}
+constexpr uint8_t TWCR_NEXT_BYTE = _BV(TWIE) | _BV(TWINT) | _BV(TWEA) | _BV(TWEN);
+
+#ifdef I2C_LOAD_ACCOUNTING
+static volatile BusLoad busLoad = {0, 0, 0};
+#endif
 
 void octoglow::front_display::i2c::init() {
-    // load address into TWI address register
+    // load address into TWI address register, the mask makes it match the event address too
     TWAR = (SLAVE_ADDRESS << 1);
+    TWAMR = ((SLAVE_ADDRESS ^ EVENT_SLAVE_ADDRESS) << 1);
 
-    prepareForNextByte();
+    TWCR = TWCR_NEXT_BYTE;
 }
 
-uint8_t octoglow::front_display::i2c::crc8ccittUpdate(const uint8_t inCrc, const uint8_t inData) {
-    return _crc8_ccitt_update(inCrc, inData);
-}
+#ifdef I2C_LOAD_ACCOUNTING
 
+BusLoad octoglow::front_display::i2c::getBusLoadAndClear() {
+    BusLoad v;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        v.interrupts = busLoad.interrupts;
+        v.maxCycles = busLoad.maxCycles;
+        v.cycles = busLoad.cycles;
 
-ISR(TWI_vect) {
-    uint8_t data;
+        busLoad.interrupts = 0;
+        busLoad.maxCycles = 0;
+        busLoad.cycles = 0;
+    }
+    return v;
+}
+
+static inline void accountInterrupt(const uint16_t startCycle) {
+    const uint16_t cycles = cyclesSince(startCycle);
 
-    // own address has been acknowledged
-    if ((TWSR & 0xF8) == TW_SR_SLA_ACK) {
-        onStart();
+    busLoad.interrupts = busLoad.interrupts + 1;
+    busLoad.cycles += cycles;
+    if (cycles > busLoad.maxCycles) {
+        busLoad.maxCycles = cycles;
+    }
+}
 
-        prepareForNextByte();
-    } else if ((TWSR & 0xF8) == TW_ST_SLA_ACK) {
-        onStart();
+#else
 
-        onTransmit(&data);
-        TWDR = data;
+BusLoad octoglow::front_display::i2c::getBusLoadAndClear() {
+    return NOT_MEASURED_BUS_LOAD;
+}
 
-        prepareForNextByte();
-    } else if ((TWSR & 0xF8) == TW_SR_DATA_ACK) {
-        onReceive(TWDR);
+#endif
 
-        prepareForNextByte();
-    } else if ((TWSR & 0xF8) == TW_ST_DATA_ACK) {
-        onTransmit(&data);
-        TWDR = data;
+ISR(TWI_vect) {
+#ifdef I2C_LOAD_ACCOUNTING
+    const uint16_t startCycle = cycleCounter();
+#endif
+    uint8_t control = TWCR_NEXT_BYTE;
 
-        prepareForNextByte();
-    } else {
-        // if none of the above, apply the 'prepare TWI' to be addressed again
-        TWCR |= (1 << TWIE) | (1 << TWEA) | (1 << TWEN);
+    switch (TW_STATUS) {
+        case TW_SR_DATA_ACK:
+            onReceive(TWDR);
+            break;
+        case TW_ST_SLA_ACK:
+            // the received address is in the data register
+            if ((TWDR >> 1) == EVENT_SLAVE_ADDRESS) {
+                onEventReadStart();
+            } else {
+                onStart();
+            }
+            [[fallthrough]];
+        case TW_ST_DATA_ACK: {
+            uint8_t data;
+            onTransmit(&data);
+            TWDR = data;
+        }
+            break;
+        case TW_SR_SLA_ACK:
+            onStart();
+            break;
+        case TW_BUS_ERROR:
+            // release the bus, no stop condition is actually sent by the slave
+            control |= _BV(TWSTO);
+            break;
+        default:
+            // stop condition, NACK or the last byte transmitted; wait to be addressed again
+            break;
     }
+
+    TWCR = control;
+
+#ifdef I2C_LOAD_ACCOUNTING
+    accountInterrupt(startCycle);
+#endif
 }
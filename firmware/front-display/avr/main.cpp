@@ -3,6 +3,8 @@
 #include "i2c-slave.hpp"
 #include "main.hpp"
 #include "eeprom.hpp"
+#include "pages.hpp"
+#include "settings.hpp"
 
 #include <avr/wdt.h>
 #include <avr/interrupt.h>
@@ -18,7 +20,6 @@ constexpr char aboutStaticString[] PROGMEM = "2016-20xx Michał Słomkowski slom
 
 static inline void showDemoOnDisplay() {
     display::clear();
-    display::setBrightness(3);
 
     display::setUpperBarContent(0b11111111u);
 
@@ -48,18 +49,28 @@ static inline void showDemoOnDisplay() {
     encoder::init();
     display::init();
 
-    i2c::init();
-
     if (WATCHDOG_ENABLE) {
         wdt_enable(WDTO_250MS);
     }
 
     sei();
 
-    showDemoOnDisplay();
+    display::setBrightness(3);
+
+    settings::init();
+    settings::restoreDisplayState();
+
+    if (not settings::showSplashText()) {
+        showDemoOnDisplay();
+    }
+
+    // frames are received in the free space of the arena, which the restored state has taken by now
+    i2c::init();
 
     while (true) {
+        i2c::processDataIfAvailable();
         display::pool();
+        pages::pool();
 
         if (WATCHDOG_ENABLE) {
             wdt_reset();
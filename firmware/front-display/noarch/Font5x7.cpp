@@ -1,4 +1,5 @@
 #include "Font5x7.hpp"
+#include "display.hpp"
 #include "main.hpp"
 
 const uint8_t octoglow::front_display::display::Font5x7[] PROGMEM = {
@@ -115,6 +116,21 @@ const uint8_t octoglow::front_display::display::Font5x7[] PROGMEM = {
         0x69, 0x59, 0x49, 0x4D, 0x4B,            // Code for char Ź
         0x44, 0x64, 0x55, 0x4C, 0x44,            // Code for char ź
         0x00, 0x07, 0x05, 0x07, 0x00,            // Code for degree sign
-        0xff, 0xff, 0xff, 0xff, 0xff,
-        0xff, 0x41, 0x41, 0x41, 0xff
+        0xff, 0xff, 0xff, 0xff, 0xff,            // Code for full block
+        0x14, 0x3E, 0x55, 0x41, 0x22,            // Code for euro sign
+        0x08, 0x1C, 0x2A, 0x08, 0x08,            // Code for left arrow
+        0x04, 0x02, 0x7F, 0x02, 0x04,            // Code for up arrow
+        0x08, 0x08, 0x2A, 0x1C, 0x08,            // Code for right arrow
+        0x10, 0x20, 0x7F, 0x20, 0x10,            // Code for down arrow
+        0x7C, 0x20, 0x20, 0x10, 0x3C,            // Code for micro sign
+        0x44, 0x44, 0x5F, 0x44, 0x44,            // Code for plus-minus sign
+        0x00, 0x19, 0x15, 0x12, 0x00,            // Code for superscript two
+        0x00, 0x00, 0x08, 0x00, 0x00,            // Code for middle dot
+        0x40, 0x00, 0x40, 0x00, 0x40,            // Code for horizontal ellipsis
+        0xff, 0x41, 0x41, 0x41, 0xff             // Code for invalid character
 };
+
+static_assert(sizeof(octoglow::front_display::display::Font5x7)
+              == octoglow::front_display::display::COLUMNS_IN_CHARACTER
+                 * (octoglow::front_display::display::INVALID_CHARACTER_CODE + 1 - ' '),
+              "every code point in UNICODE_GLYPHS has to have its glyph, followed by the invalid character glyph");
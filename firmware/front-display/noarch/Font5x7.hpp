@@ -6,7 +6,82 @@
 
 namespace octoglow::front_display::display {
     constexpr uint8_t UNICODE_START_CODE = 126;
-    constexpr uint8_t INVALID_CHARACTER_CODE = 147;
+
+    /**
+     * Unicode code points of the glyphs stored in Font5x7 from UNICODE_START_CODE on, in the font order.
+     * To extend the font, append the glyph columns to Font5x7 (before the invalid character glyph) and its
+     * code point here. The decoder lookup table is generated from this list at compile time.
+     */
+    constexpr uint16_t UNICODE_GLYPHS[] = {
+            0x104, 0x105, // Ąą
+            0x106, 0x107, // Ćć
+            0x118, 0x119, // Ęę
+            0x141, 0x142, // Łł
+            0x143, 0x144, // Ńń
+            0x0d3, 0x0f3, // Óó
+            0x15a, 0x15b, // Śś
+            0x179, 0x17a, // Źź
+            0x17b, 0x17c, // Żż
+            0x0b0, // degree sign
+            0x2588, // full block
+            0x20ac, // euro sign
+            0x2190, 0x2191, 0x2192, 0x2193, // arrows: left, up, right, down
+            0x0b5, // micro sign
+            0x0b1, // plus-minus sign
+            0x0b2, // superscript two
+            0x0b7, // middle dot
+            0x2026, // horizontal ellipsis
+    };
+
+    constexpr uint8_t NUMBER_OF_UNICODE_GLYPHS = sizeof(UNICODE_GLYPHS) / sizeof(UNICODE_GLYPHS[0]);
+
+    /**
+     * The last glyph in the font, displayed for every code point which has no glyph.
+     */
+    constexpr uint8_t INVALID_CHARACTER_CODE = UNICODE_START_CODE + NUMBER_OF_UNICODE_GLYPHS;
+
+    /**
+     * Character code of the font glyph of the given code point, INVALID_CHARACTER_CODE if the font has none.
+     * Linear, meant for compile-time use only.
+     */
+    constexpr uint8_t unicodeGlyphCode(const uint16_t codePoint) {
+        for (uint8_t i = 0; i != NUMBER_OF_UNICODE_GLYPHS; ++i) {
+            if (UNICODE_GLYPHS[i] == codePoint) {
+                return UNICODE_START_CODE + i;
+            }
+        }
+        return INVALID_CHARACTER_CODE;
+    }
+
+    /**
+     * Character codes following the font refer to the user glyphs uploaded at runtime.
+     */
+    constexpr uint8_t USER_GLYPH_START_CODE = INVALID_CHARACTER_CODE + 1;
+
+    struct UnicodeAlias {
+        uint16_t codePoint;
+        uint8_t characterCode;
+    };
+
+    /**
+     * Code points without a glyph of their own, displayed with the look-alike character.
+     */
+    constexpr UnicodeAlias UNICODE_ALIASES[] = {
+            {0x0a0,  ' '}, // no-break space
+            {0x2013, '-'}, // en dash
+            {0x2014, '-'}, // em dash
+            {0x2212, '-'}, // minus sign
+            {0x2018, '\''}, // left single quotation mark
+            {0x2019, '\''}, // right single quotation mark
+            {0x201c, '"'}, // left double quotation mark
+            {0x201d, '"'}, // right double quotation mark
+            {0x201e, '"'}, // double low-9 quotation mark
+            {0x0d7,  'x'}, // multiplication sign
+            {0x2022, unicodeGlyphCode(0x0b7)}, // bullet, as middle dot
+            {0xfffd, INVALID_CHARACTER_CODE}, // replacement character
+    };
+
+    constexpr uint8_t NUMBER_OF_UNICODE_ALIASES = sizeof(UNICODE_ALIASES) / sizeof(UNICODE_ALIASES[0]);
 
     extern const uint8_t Font5x7[] PROGMEM;
 }
@@ -0,0 +1,133 @@
+#include "arena.hpp"
+
+#include <string.h>
+
+using namespace octoglow::front_display::arena;
+
+constexpr uint8_t POOL_SIZE = SIZE + RECEIVE_RESERVE;
+
+static_assert(POOL_SIZE >= SIZE, "pool size doesn't fit uint8_t");
+
+struct Block {
+    uint8_t offset;
+    uint8_t size;
+};
+
+static uint8_t pool[POOL_SIZE];
+static Block blocks[MAX_ALLOCATIONS];
+static uint8_t usedBytes = 0;
+
+/*
+ * Bit per handle, set while the block is allocated.
+ */
+static uint8_t usedHandles[(MAX_ALLOCATIONS + 7) / 8];
+
+/*
+ * End of the space the blocks can take, lowered while the top of the pool is kept.
+ */
+static uint8_t limit = SIZE;
+
+static inline bool isUsed(const Handle handle) {
+    return usedHandles[handle / 8] & (1 << (handle % 8));
+}
+
+void octoglow::front_display::arena::init() {
+    memset(blocks, 0, sizeof(blocks));
+    memset(usedHandles, 0, sizeof(usedHandles));
+    usedBytes = 0;
+    limit = SIZE;
+}
+
+static Handle allocateBelow(const uint8_t end, const uint8_t size) {
+    if (usedBytes + size > end) {
+        return INVALID_HANDLE;
+    }
+
+    for (Handle h = 0; h != MAX_ALLOCATIONS; ++h) {
+        if (not isUsed(h)) {
+            blocks[h] = {usedBytes, size};
+            usedHandles[h / 8] |= 1 << (h % 8);
+            usedBytes += size;
+            return h;
+        }
+    }
+
+    return INVALID_HANDLE;
+}
+
+bool octoglow::front_display::arena::resize(const Handle handle, const uint8_t newSize) {
+    if (handle >= MAX_ALLOCATIONS) {
+        return false;
+    }
+
+    Block &block = blocks[handle];
+
+    if (newSize > block.size and newSize - block.size > available()) {
+        return false;
+    }
+
+    const uint8_t tailStart = block.offset + block.size;
+    const uint8_t newTailStart = block.offset + newSize;
+
+    memmove(pool + newTailStart, pool + tailStart, usedBytes - tailStart);
+
+    for (Handle h = 0; h != MAX_ALLOCATIONS; ++h) {
+        if (Block &b = blocks[h]; isUsed(h) and b.offset >= tailStart and h != handle) {
+            b.offset = b.offset + newTailStart - tailStart;
+        }
+    }
+
+    usedBytes = usedBytes + newTailStart - tailStart;
+    block.size = newSize;
+
+    return true;
+}
+
+void octoglow::front_display::arena::release(Handle &handle) {
+    if (handle >= MAX_ALLOCATIONS) {
+        return;
+    }
+
+    resize(handle, 0);
+    usedHandles[handle / 8] &= ~(1 << (handle % 8));
+    handle = INVALID_HANDLE;
+}
+
+uint8_t *octoglow::front_display::arena::get(const Handle handle) {
+    return pool + blocks[handle].offset;
+}
+
+uint8_t octoglow::front_display::arena::size(const Handle handle) {
+    return handle < MAX_ALLOCATIONS ? blocks[handle].size : 0;
+}
+
+Handle octoglow::front_display::arena::allocate(const uint8_t size) {
+    return allocateBelow(limit, size);
+}
+
+Handle octoglow::front_display::arena::allocateOverTop(const uint8_t maxSize) {
+    const uint8_t left = usedBytes < SIZE ? SIZE - usedBytes : 0;
+    return allocateBelow(SIZE, maxSize < left ? maxSize : left);
+}
+
+uint8_t octoglow::front_display::arena::available() {
+    // the blocks allocated over the kept top can end above the limit
+    return usedBytes < limit ? limit - usedBytes : 0;
+}
+
+uint8_t *octoglow::front_display::arena::freeSpace() {
+    return pool + usedBytes;
+}
+
+uint8_t octoglow::front_display::arena::freeSpaceSize() {
+    return POOL_SIZE - usedBytes;
+}
+
+uint8_t *octoglow::front_display::arena::keepTop(const uint8_t size) {
+    limit = size > RECEIVE_RESERVE ? POOL_SIZE - size : SIZE;
+    return pool + POOL_SIZE - size;
+}
+
+void octoglow::front_display::arena::releaseTop() {
+    limit = SIZE;
+}
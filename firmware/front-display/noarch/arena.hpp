@@ -0,0 +1,75 @@
+#pragma once
+
+#include <inttypes.h>
+
+/*
+ * Shared memory pool for variable-size display data. Allocations are kept contiguous: releasing or resizing
+ * a block moves the blocks above it, so the free space is always in one piece at the top of the pool.
+ * Because of that, pointers returned by get() are valid only until the next allocate(), resize() or release().
+ * The free space is also where the I2C slave receives the frames, so no separate receive buffer is needed;
+ * a frame which doesn't fit it is rejected with protocol::NO_SPACE_RESPONSE.
+ */
+namespace octoglow::front_display::arena {
+    constexpr uint8_t SIZE = 243;
+    constexpr uint8_t MAX_ALLOCATIONS = 17; // all scrolling slots, user glyphs, charts and the layers
+
+    /**
+     * Bytes above SIZE which the blocks never take, so that a frame of a fixed-length command can always be received.
+     */
+    constexpr uint8_t RECEIVE_RESERVE = 12;
+
+    using Handle = uint8_t;
+
+    constexpr Handle INVALID_HANDLE = 0xff;
+
+    void init();
+
+    /**
+     * @return handle to the new block or INVALID_HANDLE if there is no space or no free handle
+     */
+    Handle allocate(uint8_t size);
+
+    /**
+     * Grows or shrinks the block, the content is preserved up to the smaller size.
+     * @return false if there is not enough space, the block is left unchanged then
+     */
+    bool resize(Handle handle, uint8_t newSize);
+
+    /**
+     * Frees the block and sets the handle to INVALID_HANDLE. Does nothing for INVALID_HANDLE.
+     */
+    void release(Handle &handle);
+
+    uint8_t *get(Handle handle);
+
+    uint8_t size(Handle handle);
+
+    /**
+     * @return number of bytes allocate() and resize() can still take
+     */
+    uint8_t available();
+
+    /**
+     * Beginning of the free space above the blocks, RECEIVE_RESERVE included. The content is overwritten
+     * by the next allocate() or resize() which grows the used space.
+     */
+    uint8_t *freeSpace();
+
+    uint8_t freeSpaceSize();
+
+    /**
+     * Keeps the top bytes of the pool out of the reach of allocate() and resize() until releaseTop().
+     * The size must not exceed freeSpaceSize().
+     * @return beginning of the kept bytes
+     */
+    uint8_t *keepTop(uint8_t size);
+
+    void releaseTop();
+
+    /**
+     * Allocates maxSize bytes or all the space left, if less. Unlike allocate(), the block can take the kept top
+     * of the pool too. It's meant for copying the data from there: the block starts below the data, so copying
+     * it front to back reads every byte before it's overwritten.
+     */
+    Handle allocateOverTop(uint8_t maxSize);
+}
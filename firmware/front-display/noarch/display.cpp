@@ -2,167 +2,617 @@
 #include "Font5x7.hpp"
 #include "display.hpp"
 #include "main.hpp"
+#include "arena.hpp"
 
 #include <string.h>
 
+using namespace octoglow::front_display;
 using namespace octoglow::front_display::display;
 using namespace octoglow::front_display::protocol;
 
 constexpr uint8_t LOOP_NUMBER_OF_SPACES = 2;
 
-static uint16_t scrollingWaitCounter = 0;
+constexpr uint8_t UPPER_BAR_LENGTH = 20;
 
-constexpr uint8_t SCROL_TEXT_BUFFER_TRAILING_OVERHEAD = 4;
-static uint8_t scrolTextBuffer0[scroll::SLOT0_MAX_LENGTH + SCROL_TEXT_BUFFER_TRAILING_OVERHEAD];
-static uint8_t scrolTextBuffer1[scroll::SLOT1_MAX_LENGTH + SCROL_TEXT_BUFFER_TRAILING_OVERHEAD];
-static uint8_t scrolTextBuffer2[scroll::SLOT2_MAX_LENGTH + SCROL_TEXT_BUFFER_TRAILING_OVERHEAD];
+constexpr uint8_t NUM_OF_COLUMNS = NUM_OF_CHARACTERS * COLUMNS_IN_CHARACTER;
+
+/**
+ * The display has two lines, the lower one starts this many columns after the upper one.
+ */
+constexpr uint8_t LINE_COLUMNS = NUM_OF_COLUMNS / 2;
+
+/**
+ * In the scrolled column stream every character is followed by a single blank column.
+ */
+constexpr uint8_t SCROLL_COLUMNS_PER_CHARACTER = COLUMNS_IN_CHARACTER + 1;
+
+static uint8_t lastFrameTicks = 0;
 
 namespace octoglow::front_display::display {
     uint8_t _frameBuffer[NUM_OF_CHARACTERS * COLUMNS_IN_CHARACTER];
     uint32_t _upperBarBuffer = 0l;
-    uint8_t _brightness = MAX_BRIGHTNESS;
+    uint8_t _brightness = MAX_FINE_BRIGHTNESS;
+    volatile uint16_t _frameTicks = 0;
 
-    _ScrollingSlot _scrollingSlots[3] = {
-            {0, 0, 0, 0, scroll::SLOT0_MAX_LENGTH, scrolTextBuffer0},
-            {0, 0, 0, 0, scroll::SLOT1_MAX_LENGTH, scrolTextBuffer1},
-            {0, 0, 0, 0, scroll::SLOT2_MAX_LENGTH, scrolTextBuffer2}
+    _ScrollingSlot _scrollingSlots[scroll::MAX_NUMBER_OF_SLOTS] = {
+            {0, 0, 0, 0, scroll::SLOT0_MAX_LENGTH, arena::INVALID_HANDLE, scroll::DEFAULT_SPEED, 0, false, 0},
+            {0, 0, 0, 0, scroll::SLOT1_MAX_LENGTH, arena::INVALID_HANDLE, scroll::DEFAULT_SPEED, 0, false, 0},
+            {0, 0, 0, 0, scroll::SLOT2_MAX_LENGTH, arena::INVALID_HANDLE, scroll::DEFAULT_SPEED, 0, false, 0},
+            {0, 0, 0, 0, 0, arena::INVALID_HANDLE, scroll::DEFAULT_SPEED, 0, false, 0},
+            {0, 0, 0, 0, 0, arena::INVALID_HANDLE, scroll::DEFAULT_SPEED, 0, false, 0},
     };
 
-    static_assert(sizeof(_scrollingSlots) / sizeof(_scrollingSlots[0]) == scroll::NUMBER_OF_SLOTS,
+    static_assert(sizeof(_scrollingSlots) / sizeof(_scrollingSlots[0]) == scroll::MAX_NUMBER_OF_SLOTS,
                   "slot number doesn't match");
+
+    uint8_t _numberOfScrollingSlots = scroll::NUMBER_OF_SLOTS;
+
+    _Chart _charts[chart::MAX_NUMBER_OF_CHARTS] = {
+            {0, 0, 0, 1, 0, arena::INVALID_HANDLE},
+            {0, 0, 0, 1, 0, arena::INVALID_HANDLE},
+    };
+
+    static_assert(sizeof(_charts) / sizeof(_charts[0]) == chart::MAX_NUMBER_OF_CHARTS,
+                  "chart number doesn't match");
+
+    _NumberWidget _numberWidgets[widget::MAX_NUMBER_OF_WIDGETS];
+
+    arena::Handle _userGlyphs[glyph::MAX_NUMBER_OF_GLYPHS] = {
+            arena::INVALID_HANDLE, arena::INVALID_HANDLE, arena::INVALID_HANDLE, arena::INVALID_HANDLE,
+            arena::INVALID_HANDLE, arena::INVALID_HANDLE, arena::INVALID_HANDLE, arena::INVALID_HANDLE,
+    };
+
+    static_assert(sizeof(_userGlyphs) / sizeof(_userGlyphs[0]) == glyph::MAX_NUMBER_OF_GLYPHS,
+                  "glyph number doesn't match");
+
+    arena::Handle _textLayer = arena::INVALID_HANDLE;
+    uint8_t _blinkingCells[CELL_SET_BYTES];
+    uint8_t _invertedCells[CELL_SET_BYTES];
+    uint8_t _dimmedCells[CELL_SET_BYTES];
+    uint8_t _textLayerBlending = static_cast<uint8_t>(layer::Blending::OR);
+    _Overlay _overlay = {0, static_cast<uint8_t>(layer::Blending::OR), 0, arena::INVALID_HANDLE};
+    _Transition _transition = {0, false, false, 0, 0, 0, 1, arena::INVALID_HANDLE};
+    static_assert(USER_GLYPH_START_CODE + glyph::MAX_NUMBER_OF_GLYPHS <= 0x100,
+                  "user glyph codes have to fit in a byte");
+}
+
+/**
+ * Column of the font glyph or the user glyph. User glyphs narrower than the character are padded with blank columns.
+ */
+static uint8_t characterColumn(const uint8_t code, const uint8_t columnOffset) {
+    if (code >= USER_GLYPH_START_CODE) {
+        const arena::Handle handle = _userGlyphs[code - USER_GLYPH_START_CODE];
+        return columnOffset < arena::size(handle) ? arena::get(handle)[columnOffset] : 0;
+    }
+
+    return pgm_read_byte(Font5x7 + COLUMNS_IN_CHARACTER * (code - ' ') + columnOffset);
+}
+
+
+struct AnodeBit {
+    uint8_t column;
+    uint8_t rowMask;
+};
+
+constexpr uint8_t UPPER_BAR_SEGMENT = 0xff;
+
+constexpr AnodeBit dummy() {
+    return {0, 0};
+}
+
+constexpr AnodeBit dot(const uint8_t column, const uint8_t row) {
+    return {column, static_cast<uint8_t>(1 << row)};
+}
+
+/*
+ * Order in which the anodes of a single grid are wired to the driver chain. Dummy bits are always zero.
+ */
+static constexpr AnodeBit anodeSequence[8 * WIRE_IMAGE_BYTES_PER_GRID] PROGMEM = {
+        // a1 - a11
+        dot(2, 3), dot(3, 3), dot(4, 3), dot(0, 4), dot(1, 4), dot(2, 4), dot(3, 4), dot(4, 4),
+        dot(0, 5), dot(1, 5), dot(2, 5),
+        // a18 - a14
+        dot(4, 6), dot(3, 6), dot(2, 6), dot(1, 6), dot(0, 6),
+        dummy(), dummy(),
+        // a12 - a13
+        dot(3, 5), dot(4, 5),
+        dummy(), dummy(),
+        // a25 - a19
+        dot(0, 2), dot(1, 2), dot(2, 2), dot(3, 2), dot(4, 2), dot(0, 3), dot(1, 3),
+        // a26 - a35
+        dot(4, 1), dot(3, 1), dot(2, 1), dot(1, 1), dot(0, 1), dot(4, 0), dot(3, 0), dot(2, 0),
+        dot(1, 0), dot(0, 0),
+        // a36 - upper bar
+        {UPPER_BAR_SEGMENT, 0}
+};
+
+static uint8_t blend(const uint8_t below, const uint8_t above, const uint8_t blending) {
+    switch (static_cast<layer::Blending>(blending)) {
+        case layer::Blending::REPLACE:
+            return above;
+        case layer::Blending::MASK:
+            return below & ~above;
+        default:
+            return below | above;
+    }
+}
+
+/**
+ * Blends the text layer cell and the overlay over the framebuffer columns of the character position.
+ * @return the composed columns or the framebuffer itself if no layer covers the position
+ */
+static const uint8_t *composeCharacter(const uint8_t position, uint8_t *const composed) {
+    const uint8_t firstColumn = COLUMNS_IN_CHARACTER * position;
+    // the handles are read once, the main loop may release the blocks meanwhile
+    const arena::Handle textLayer = _textLayer;
+    const arena::Handle overlayColumns = _overlay.columns;
+    const uint8_t textCode = textLayer != arena::INVALID_HANDLE ? arena::get(textLayer)[position] : 0;
+    const uint8_t overlayWidth = arena::size(overlayColumns);
+    const uint8_t overlayEnd = _overlay.columnPosition + overlayWidth;
+    const bool overlayCovers = overlayWidth != 0
+                               and firstColumn < overlayEnd
+                               and firstColumn + COLUMNS_IN_CHARACTER > _overlay.columnPosition;
+
+    if (textCode == 0 and not overlayCovers) {
+        return _frameBuffer + firstColumn;
+    }
+
+    for (uint8_t c = 0; c != COLUMNS_IN_CHARACTER; ++c) {
+        const uint8_t column = firstColumn + c;
+        uint8_t value = _frameBuffer[column];
+
+        if (textCode != 0) {
+            value = blend(value, characterColumn(textCode, c), _textLayerBlending);
+        }
+        if (overlayCovers and column >= _overlay.columnPosition and column < overlayEnd) {
+            value = blend(value, arena::get(overlayColumns)[column - _overlay.columnPosition], _overlay.blending);
+        }
+
+        composed[c] = value;
+    }
+
+    return composed;
+}
+
+static constexpr bool dotMaskMatchesAnodeSequence() {
+    for (uint8_t i = 0; i != 8 * WIRE_IMAGE_BYTES_PER_GRID; ++i) {
+        const bool isDot = anodeSequence[i].column != UPPER_BAR_SEGMENT and anodeSequence[i].rowMask != 0;
+        if (isDot != static_cast<bool>(wireImageDotMask(i / 8) & (0x80 >> (i % 8)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(dotMaskMatchesAnodeSequence(), "wireImageDotMask() has to match the anode sequence");
+
+/**
+ * Builds the anode bits of the grid from the framebuffer, the layers and the upper bar.
+ */
+static void composeGridImage(const uint8_t position, uint8_t *const image) {
+    uint8_t composed[COLUMNS_IN_CHARACTER];
+    const uint8_t *const characterPtr = composeCharacter(position, composed);
+    const bool upperBarSegmentEnabled = position < UPPER_BAR_LENGTH and (_upperBarBuffer & (1ul << position));
+    const AnodeBit *anodeBit = anodeSequence;
+
+    for (uint8_t i = 0; i != WIRE_IMAGE_BYTES_PER_GRID; ++i) {
+        uint8_t value = 0;
+
+        for (uint8_t b = 0; b != 8; ++b) {
+            const uint8_t column = pgm_read_byte(&anodeBit->column);
+            const uint8_t rowMask = pgm_read_byte(&anodeBit->rowMask);
+            ++anodeBit;
+
+            value <<= 1;
+
+            if (column == UPPER_BAR_SEGMENT) {
+                value |= upperBarSegmentEnabled;
+            } else if (characterPtr[column] & rowMask) {
+                value |= 1;
+            }
+        }
+
+        image[i] = value;
+    }
+}
+
+static uint8_t *frozenGrid(const uint8_t position) {
+    return arena::get(_transition.frozenImage) + WIRE_IMAGE_BYTES_PER_GRID * position;
 }
 
+void octoglow::front_display::display::_buildGridImage(const uint8_t position, uint8_t *const image) {
+    // the displayed image is frozen while staging or transition
+    if (_transition.frozenImage != arena::INVALID_HANDLE) {
+        memcpy(image, frozenGrid(position), WIRE_IMAGE_BYTES_PER_GRID);
+    } else {
+        composeGridImage(position, image);
+    }
+}
 
 void _ScrollingSlot::clear() {
     startPosition = 0;
     length = 0;
     textLength = 0;
+    ticker = false;
+    tickerHead = 0;
+    arena::release(convertedText);
 }
 
-void _ScrollingSlot::scrollAndLoadIntoFramebuffer() {
+uint16_t _ScrollingSlot::streamLength() const {
+    return SCROLL_COLUMNS_PER_CHARACTER * (this->textLength + LOOP_NUMBER_OF_SPACES);
+}
+
+uint8_t _ScrollingSlot::columnAt(const uint16_t streamColumn) const {
+    const uint8_t characterOffset = streamColumn / SCROLL_COLUMNS_PER_CHARACTER;
+    const uint8_t columnOffset = streamColumn % SCROLL_COLUMNS_PER_CHARACTER;
+
+    if (characterOffset >= this->textLength or columnOffset == COLUMNS_IN_CHARACTER) {
+        return 0;
+    }
+
+    const uint8_t *const text = arena::get(this->convertedText);
+
+    if (this->ticker) {
+        const uint8_t capacity = arena::size(this->convertedText);
+        const uint16_t index = this->tickerHead + characterOffset;
+        return characterColumn(text[index < capacity ? index : index - capacity], columnOffset);
+    }
+
+    return characterColumn(text[characterOffset], columnOffset);
+}
+
+void _ScrollingSlot::loadIntoFramebuffer() {
     if (this->textLength == 0 or this->length == 0) {
         return;
     }
 
-    uint8_t characterOffset = this->currentShift / COLUMNS_IN_CHARACTER;
-    uint8_t columnOffset = this->currentShift % COLUMNS_IN_CHARACTER;
-    uint8_t charactersSkpLines = 0;
+    uint8_t *const window = _frameBuffer + COLUMNS_IN_CHARACTER * this->startPosition;
+    const uint16_t period = this->streamLength();
+    uint16_t streamColumn = this->currentShift;
 
-    for (uint8_t p = 0; p + charactersSkpLines < this->length * COLUMNS_IN_CHARACTER; ++p) {
+    for (uint8_t c = 0; c != COLUMNS_IN_CHARACTER * this->length; ++c) {
+        window[c] = this->columnAt(streamColumn);
 
-        const uint8_t op = characterOffset;
-        uint8_t character;
-
-        if (op < this->textLength) {
-            character = this->convertedText[op];
-        } else if (op - this->textLength < LOOP_NUMBER_OF_SPACES) {
-            character = ' ';
-        } else {
-            character = this->convertedText[(op - LOOP_NUMBER_OF_SPACES) % this->textLength];
+        // the ticker text doesn't loop
+        if (++streamColumn == period and not this->ticker) {
+            streamColumn = 0;
         }
+    }
+}
+
+void _ScrollingSlot::scrollAndLoadIntoFramebuffer() {
+    if (this->textLength == 0 or this->length == 0) {
+        return;
+    }
 
-        const uint8_t frameBufferColumn = COLUMNS_IN_CHARACTER * this->startPosition + p;
+    if (this->ticker) {
+        this->scrollTicker();
+        return;
+    }
 
-        _frameBuffer[frameBufferColumn + charactersSkpLines]
-                = pgm_read_byte(Font5x7 + COLUMNS_IN_CHARACTER * (character - ' ') + columnOffset);
+    uint8_t *const window = _frameBuffer + COLUMNS_IN_CHARACTER * this->startPosition;
+    const uint8_t windowColumns = COLUMNS_IN_CHARACTER * this->length;
+    const uint16_t period = this->streamLength();
 
-        ++columnOffset;
+    memmove(window, window + 1, windowColumns - 1);
 
-        if (columnOffset == COLUMNS_IN_CHARACTER) {
-            _frameBuffer[frameBufferColumn + charactersSkpLines + 1] = 0;
-            columnOffset = 0;
-            ++characterOffset;
-            ++charactersSkpLines;
-        }
+    uint16_t newColumn = this->currentShift + windowColumns;
+    while (newColumn >= period) {
+        newColumn -= period;
     }
+    window[windowColumns - 1] = this->columnAt(newColumn);
 
     this->currentShift++;
 
-    if (this->currentShift == COLUMNS_IN_CHARACTER * (this->textLength + 2u)) {
+    if (this->currentShift == period) {
+        this->currentShift = 0;
+    }
+}
+
+void _ScrollingSlot::padTicker(const uint8_t characterOffset) {
+    const uint8_t capacity = arena::size(this->convertedText);
+    uint8_t *const text = arena::get(this->convertedText);
+
+    while (this->textLength <= characterOffset and this->textLength != capacity) {
+        const uint16_t index = this->tickerHead + this->textLength;
+        text[index < capacity ? index : index - capacity] = ' ';
+        ++this->textLength;
+    }
+}
+
+void _ScrollingSlot::scrollTicker() {
+    uint8_t *const window = _frameBuffer + COLUMNS_IN_CHARACTER * this->startPosition;
+    const uint8_t windowColumns = COLUMNS_IN_CHARACTER * this->length;
+    const uint16_t newColumn = this->currentShift + windowColumns;
+
+    memmove(window, window + 1, windowColumns - 1);
+
+    this->padTicker(newColumn / SCROLL_COLUMNS_PER_CHARACTER);
+    window[windowColumns - 1] = this->columnAt(newColumn);
+
+    if (++this->currentShift == SCROLL_COLUMNS_PER_CHARACTER) {
+        // the first character has left the window, reclaim it
         this->currentShift = 0;
+        --this->textLength;
+        if (++this->tickerHead == arena::size(this->convertedText)) {
+            this->tickerHead = 0;
+        }
+    }
+}
+
+void _ScrollingSlot::advance(const uint8_t elapsedFrames) {
+    uint16_t accumulator = this->speedAccumulator + static_cast<uint16_t>(elapsedFrames) * this->speed;
+
+    while (accumulator >= FRAME_RATE) {
+        accumulator -= FRAME_RATE;
+        this->scrollAndLoadIntoFramebuffer();
     }
+
+    this->speedAccumulator = accumulator;
+}
+
+constexpr uint8_t GLYPH_LOOKUP_SIZE = 64;
+constexpr uint8_t GLYPH_LOOKUP_SHIFT = 10;
+static_assert(GLYPH_LOOKUP_SIZE == (1u << (16 - GLYPH_LOOKUP_SHIFT)), "lookup size has to match the hash shift");
+
+constexpr uint8_t GLYPH_LOOKUP_BUCKETS = 16;
+
+constexpr uint8_t NUMBER_OF_MAPPED_CODE_POINTS = NUMBER_OF_UNICODE_GLYPHS + NUMBER_OF_UNICODE_ALIASES;
+
+static constexpr uint16_t mappedCodePoint(const uint8_t index) {
+    return index < NUMBER_OF_UNICODE_GLYPHS
+           ? UNICODE_GLYPHS[index]
+           : UNICODE_ALIASES[index - NUMBER_OF_UNICODE_GLYPHS].codePoint;
 }
 
-static const uint16_t utfMappings[] PROGMEM = {
-        0x104, 0x105,
-        0x106, 0x107,
-        0x118, 0x119,
-        0x141, 0x142,
-        0x143, 0x144,
-        0x0d3, 0x0f3,
-        0x15a, 0x15b,
-        0x179, 0x17a,
-        0x17b, 0x17c,
-        0xb0 // degree sign
+static constexpr uint8_t mappedCharacterCode(const uint8_t index) {
+    return index < NUMBER_OF_UNICODE_GLYPHS
+           ? UNICODE_START_CODE + index
+           : UNICODE_ALIASES[index - NUMBER_OF_UNICODE_GLYPHS].characterCode;
+}
+
+static constexpr uint8_t glyphLookupBucket(const uint16_t codePoint) {
+    return codePoint % GLYPH_LOOKUP_BUCKETS;
+}
+
+static constexpr uint8_t glyphLookupSlot(const uint16_t codePoint, const uint16_t multiplier) {
+    return static_cast<uint16_t>(static_cast<uint32_t>(codePoint) * multiplier) >> GLYPH_LOOKUP_SHIFT;
+}
+
+/**
+ * Perfect hash table mapping the code points of UNICODE_GLYPHS and UNICODE_ALIASES to the character codes.
+ * Code points are split into buckets, every bucket has its own hash multiplier chosen at compile time
+ * so that no two code points share a slot. Code points are never zero, so the empty slots hold code point 0.
+ */
+struct GlyphLookupTable {
+    uint16_t multipliers[GLYPH_LOOKUP_BUCKETS];
+
+    struct Entry {
+        uint16_t codePoint;
+        uint8_t characterCode;
+    } entries[GLYPH_LOOKUP_SIZE];
+
+    bool complete;
+
+    constexpr GlyphLookupTable() : multipliers(), entries(), complete(true) {
+        for (auto &entry : entries) {
+            entry = {0, INVALID_CHARACTER_CODE};
+        }
+
+        bool taken[GLYPH_LOOKUP_SIZE] = {};
+
+        // buckets holding the most code points are the hardest to place, so they go first
+        for (uint8_t bucketSize = NUMBER_OF_MAPPED_CODE_POINTS; bucketSize != 0; --bucketSize) {
+            for (uint8_t bucket = 0; bucket != GLYPH_LOOKUP_BUCKETS; ++bucket) {
+                if (codePointsInBucket(bucket) == bucketSize) {
+                    complete = complete and placeBucket(bucket, taken);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint8_t codePointsInBucket(const uint8_t bucket) {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i != NUMBER_OF_MAPPED_CODE_POINTS; ++i) {
+            if (glyphLookupBucket(mappedCodePoint(i)) == bucket) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    constexpr bool placeBucket(const uint8_t bucket, bool (&taken)[GLYPH_LOOKUP_SIZE]) {
+        for (uint16_t multiplier = 1; multiplier != 0xffff; multiplier += 2) {
+            bool trial[GLYPH_LOOKUP_SIZE] = {};
+            bool fits = true;
+
+            for (uint8_t i = 0; i != NUMBER_OF_MAPPED_CODE_POINTS and fits; ++i) {
+                if (glyphLookupBucket(mappedCodePoint(i)) == bucket) {
+                    const uint8_t slot = glyphLookupSlot(mappedCodePoint(i), multiplier);
+                    fits = not taken[slot] and not trial[slot];
+                    trial[slot] = true;
+                }
+            }
+
+            if (fits) {
+                multipliers[bucket] = multiplier;
+                for (uint8_t i = 0; i != NUMBER_OF_MAPPED_CODE_POINTS; ++i) {
+                    if (glyphLookupBucket(mappedCodePoint(i)) == bucket) {
+                        const uint8_t slot = glyphLookupSlot(mappedCodePoint(i), multiplier);
+                        entries[slot] = {mappedCodePoint(i), mappedCharacterCode(i)};
+                        taken[slot] = true;
+                    }
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
 };
 
+static_assert(GlyphLookupTable().complete,
+              "no collision-free glyph lookup found, check for duplicate code points or enlarge GLYPH_LOOKUP_SIZE");
+
+static const GlyphLookupTable glyphLookupTable PROGMEM = GlyphLookupTable();
+
+uint8_t octoglow::front_display::display::_characterCodeOf(const uint16_t codePoint) {
+    if (static_cast<uint16_t>(codePoint - glyph::FIRST_CODE_POINT) < glyph::MAX_NUMBER_OF_GLYPHS) {
+        return USER_GLYPH_START_CODE + (codePoint - glyph::FIRST_CODE_POINT);
+    }
+
+    const uint16_t multiplier = pgm_read_word(&glyphLookupTable.multipliers[glyphLookupBucket(codePoint)]);
+    const GlyphLookupTable::Entry &entry = glyphLookupTable.entries[glyphLookupSlot(codePoint, multiplier)];
+
+    if (pgm_read_word(&entry.codePoint) != codePoint) {
+        return INVALID_CHARACTER_CODE;
+    }
+
+    return pgm_read_byte(&entry.characterCode);
+}
+
+static inline uint8_t readStringByte(const char *str, const bool stringInProgramSpace, const uint8_t index) {
+    return stringInProgramSpace
+           ? pgm_read_byte(str + index)
+           : reinterpret_cast<const uint8_t & >(str[index]);
+}
+
+uint8_t octoglow::front_display::display::Utf8Decoder::decode(const uint8_t byte, uint8_t *const codes) {
+    uint8_t count = 0;
+
+    if (this->pendingBytes != 0) {
+        if ((byte & 0xc0) == 0x80) {
+            this->codePoint = (this->codePoint << 6) | (byte & 0x3f);
+
+            if (--this->pendingBytes != 0) {
+                return 0;
+            }
+
+            codes[0] = this->representable ? _characterCodeOf(this->codePoint) : INVALID_CHARACTER_CODE;
+            return 1;
+        }
+
+        // truncated sequence; the byte, possibly the terminating zero, starts the next character
+        this->pendingBytes = 0;
+        codes[count++] = INVALID_CHARACTER_CODE;
+    }
+
+    if (byte < 0x80) {
+        codes[count++] = byte;
+    } else if ((byte & 0xe0) == 0xc0) {
+        this->pendingBytes = 1;
+        this->codePoint = byte & 0x1f;
+        this->representable = true;
+    } else if ((byte & 0xf0) == 0xe0) {
+        this->pendingBytes = 2;
+        this->codePoint = byte & 0x0f;
+        this->representable = true;
+    } else if ((byte & 0xf8) == 0xf0) {
+        // beyond the basic multilingual plane, the font has no such glyphs; the sequence is only skipped
+        this->pendingBytes = 3;
+        this->codePoint = 0;
+        this->representable = false;
+    } else {
+        // stray continuation byte or invalid lead byte
+        codes[count++] = INVALID_CHARACTER_CODE;
+    }
+
+    return count;
+}
+
+void octoglow::front_display::display::convertUtf8InPlace(uint8_t *const text) {
+    Utf8Decoder decoder{};
+    uint8_t readIdx = 0;
+    uint8_t writeIdx = 0;
+
+    // every character takes at least as many bytes as the codes decoded from it, so the writing never overtakes
+    while (true) {
+        uint8_t codes[2];
+        const uint8_t count = decoder.decode(text[readIdx++], codes);
+
+        for (uint8_t i = 0; i != count; ++i) {
+            text[writeIdx++] = codes[i];
+            if (codes[i] == 0) {
+                return;
+            }
+        }
+    }
+}
+
 void octoglow::front_display::display::_forEachUtf8character(const char *str,
                                  const bool stringInProgramSpace,
                                  const uint8_t maxLength,
                                  void *const userData,
                                  void (*callback)(void *, uint8_t, uint8_t)) {
+    Utf8Decoder decoder{};
     uint8_t strIdx = 0;
     uint8_t currPos = 0;
 
     while (currPos < maxLength) {
-        const uint8_t singleAsciiValue = stringInProgramSpace
-                                         ? pgm_read_byte(str + strIdx)
-                                         : reinterpret_cast<const uint8_t & >(str[strIdx]);
-
-        if (singleAsciiValue == 0) {
-            break;
-        }
-
-        if (singleAsciiValue < 0x80) {
-            strIdx++;
-            callback(userData, currPos, singleAsciiValue);
-        } else {
-            const uint8_t secondByteValue = stringInProgramSpace
-                                            ? pgm_read_byte(str + strIdx + 1)
-                                            : reinterpret_cast<const uint8_t & >(str[strIdx + 1]);
-            const uint16_t twoByteUnicodeValue = (secondByteValue & 0x3f) + ((singleAsciiValue & 0x1f) << 6);
-            strIdx += 2;
-
-            constexpr uint8_t NUMBER_OF_NATIONAL_CHARACTERS = sizeof(utfMappings) / sizeof(utfMappings[0]);
-            uint8_t offset;
-            for (offset = 0; offset < NUMBER_OF_NATIONAL_CHARACTERS; ++offset) {
-                if (pgm_read_word(&utfMappings[offset]) == twoByteUnicodeValue) {
-                    break;
-                }
-            }
+        uint8_t codes[2];
+        const uint8_t count = decoder.decode(readStringByte(str, stringInProgramSpace, strIdx++), codes);
 
-            if (offset == NUMBER_OF_NATIONAL_CHARACTERS) {
-                offset = INVALID_CHARACTER_CODE - UNICODE_START_CODE;
+        for (uint8_t i = 0; i != count and currPos < maxLength; ++i) {
+            if (codes[i] == 0) {
+                return;
             }
 
-            callback(userData, currPos, UNICODE_START_CODE + offset);
+            callback(userData, currPos, codes[i]);
+            ++currPos;
         }
-
-        ++currPos;
     }
 }
 
+/**
+ * Text given to the write functions: UTF-8, in RAM or in program space, or already converted character codes.
+ */
+struct TextSource {
+    const char *text;
+    bool inProgramSpace;
+    bool converted;
+};
 
-void octoglow::front_display::display::writeStaticText(const uint8_t position,
-                                                       const uint8_t maxLength,
-                                                       const char *const text,
-                                                       const bool textInProgramSpace) {
+static void forEachCharacter(const TextSource &source,
+                             const uint8_t maxLength,
+                             void *const userData,
+                             void (*callback)(void *, uint8_t, uint8_t)) {
+    if (not source.converted) {
+        _forEachUtf8character(source.text, source.inProgramSpace, maxLength, userData, callback);
+        return;
+    }
+
+    const auto *const codes = reinterpret_cast<const uint8_t *>(source.text);
+    for (uint8_t pos = 0; pos < maxLength and codes[pos] != 0; ++pos) {
+        callback(userData, pos, codes[pos]);
+    }
+}
+
+static void writeStaticTextFrom(const uint8_t position, const uint8_t maxLength, const TextSource &source) {
     struct LocalData {
         uint8_t startPosition;
         uint8_t lastPos;
     } local{position, 0};
 
-    _forEachUtf8character(text, textInProgramSpace, maxLength, &local,
-                         [](void *s, const uint8_t curPos, const uint8_t code) -> void {
-                             const auto ld = static_cast<LocalData *>(s);
+    forEachCharacter(source, maxLength, &local,
+                     [](void *s, const uint8_t curPos, const uint8_t code) -> void {
+                         const auto ld = static_cast<LocalData *>(s);
+
+                         uint8_t *const destination = _frameBuffer +
+                                                      COLUMNS_IN_CHARACTER * (ld->startPosition + curPos);
 
-                             memcpy_P(_frameBuffer +
-                                      COLUMNS_IN_CHARACTER * (ld->startPosition + curPos),
+                         if (code >= USER_GLYPH_START_CODE) {
+                             for (uint8_t c = 0; c != COLUMNS_IN_CHARACTER; ++c) {
+                                 destination[c] = characterColumn(code, c);
+                             }
+                         } else {
+                             memcpy_P(destination,
                                       Font5x7 + COLUMNS_IN_CHARACTER * (code - ' '),
                                       COLUMNS_IN_CHARACTER);
+                         }
 
-                             ld->lastPos = curPos;
-                         });
+                         ld->lastPos = curPos;
+                     });
 
     if(maxLength > local.lastPos + 1) {
         memset(_frameBuffer + COLUMNS_IN_CHARACTER * (position + local.lastPos + 1),
@@ -171,77 +621,486 @@ void octoglow::front_display::display::writeStaticText(const uint8_t position,
     }
 }
 
-void octoglow::front_display::display::writeScrollingText(const uint8_t slotNumber,
-                                                          const uint8_t position,
-                                                          const uint8_t windowLength,
-                                                          const char *const text,
-                                                          const bool textInProgramSpace) {
+static void writeScrollingTextFrom(const uint8_t slotNumber,
+                                   const uint8_t position,
+                                   const uint8_t windowLength,
+                                   const TextSource &source) {
+    if (slotNumber >= _numberOfScrollingSlots) {
+        return;
+    }
 
-    _ScrollingSlot &slot = _scrollingSlots[slotNumber % scroll::NUMBER_OF_SLOTS];
+    _ScrollingSlot &slot = _scrollingSlots[slotNumber];
+    slot.clear();
     slot.startPosition = position;
     slot.length = windowLength;
     slot.currentShift = 0;
+    slot.speed = scroll::DEFAULT_SPEED;
+    slot.speedAccumulator = 0;
 
-    _forEachUtf8character(text, textInProgramSpace, slot.maxTextLength, &slot,
+    uint8_t fittingLength = 0;
+    forEachCharacter(source, windowLength + 1, &fittingLength,
+                     [](void *l, const uint8_t curPos, const uint8_t) -> void {
+                         *static_cast<uint8_t *>(l) = curPos + 1;
+                     });
+
+    /*
+     * The text is converted into all the space the slot can get, then the block is shrunk to the actual length.
+     * The text received over I2C lies in the kept top of the arena and is copied front to back, so the block
+     * can overlap it. Then the source is overwritten, that's why the text that ends up in static mode
+     * is never copied.
+     */
+    if (fittingLength > windowLength) {
+        slot.convertedText = arena::allocateOverTop(slot.maxTextLength);
+    }
+
+    if (arena::size(slot.convertedText) > windowLength) {
+        forEachCharacter(source, arena::size(slot.convertedText), &slot,
                          [](void *s, const uint8_t curPos, const uint8_t code) -> void {
-                             static_cast<_ScrollingSlot *>(s)->convertedText[curPos] = code;
-                             static_cast<_ScrollingSlot *>(s)->textLength = curPos + 1;
+                             auto *sl = static_cast<_ScrollingSlot *>(s);
+                             arena::get(sl->convertedText)[curPos] = code;
+                             sl->textLength = curPos + 1;
                          });
 
+        arena::resize(slot.convertedText, slot.textLength);
+    }
+
     if (slot.textLength <= slot.length) {
-        // if the text is shorter than the window, fall back to static mode
-        writeStaticText(slot.startPosition, slot.length, text, textInProgramSpace);
+        // if the text is shorter than the window or there is no space for it, fall back to static mode
+        writeStaticTextFrom(slot.startPosition, slot.length, source);
 
-        // disable slot
+        // disable slot, reclaim its memory
         slot.length = 0;
         slot.textLength = 0;
+        arena::release(slot.convertedText);
+    } else {
+        slot.loadIntoFramebuffer();
     }
 }
 
-void octoglow::front_display::display::clear() {
-    for (auto &scrollingSlot : _scrollingSlots) {
-        scrollingSlot.clear();
+void octoglow::front_display::display::writeStaticText(const uint8_t position,
+                                                       const uint8_t maxLength,
+                                                       const char *const text,
+                                                       const bool textInProgramSpace) {
+    writeStaticTextFrom(position, maxLength, {text, textInProgramSpace, false});
+}
+
+void octoglow::front_display::display::writeStaticCharacters(const uint8_t position,
+                                                             const uint8_t maxLength,
+                                                             const uint8_t *const characterCodes) {
+    writeStaticTextFrom(position, maxLength, {reinterpret_cast<const char *>(characterCodes), false, true});
+}
+
+void octoglow::front_display::display::writeScrollingText(const uint8_t slotNumber,
+                                                          const uint8_t position,
+                                                          const uint8_t windowLength,
+                                                          const char *const text,
+                                                          const bool textInProgramSpace) {
+    writeScrollingTextFrom(slotNumber, position, windowLength, {text, textInProgramSpace, false});
+}
+
+void octoglow::front_display::display::writeScrollingCharacters(const uint8_t slotNumber,
+                                                                const uint8_t position,
+                                                                const uint8_t windowLength,
+                                                                const uint8_t *const characterCodes) {
+    writeScrollingTextFrom(slotNumber, position, windowLength,
+                           {reinterpret_cast<const char *>(characterCodes), false, true});
+}
+
+void octoglow::front_display::display::startTicker(const uint8_t slotNumber,
+                                                   const uint8_t position,
+                                                   const uint8_t windowLength,
+                                                   const uint8_t columnsPerSecond) {
+    if (slotNumber >= _numberOfScrollingSlots) {
+        return;
     }
 
-    scrollingWaitCounter = 0;
+    _ScrollingSlot &slot = _scrollingSlots[slotNumber];
+    slot.clear();
 
-    _upperBarBuffer = 0;
+    const uint8_t available = arena::available();
+    const uint8_t capacity = slot.maxTextLength < available ? slot.maxTextLength : available;
 
-    memset(_frameBuffer, 0,
-           COLUMNS_IN_CHARACTER * NUM_OF_CHARACTERS);
+    if (capacity == 0 or windowLength == 0) {
+        return;
+    }
+
+    slot.convertedText = arena::allocate(capacity);
+    if (slot.convertedText == arena::INVALID_HANDLE) {
+        return;
+    }
+
+    slot.startPosition = position;
+    slot.length = windowLength;
+    slot.currentShift = 0;
+    slot.speed = columnsPerSecond;
+    slot.speedAccumulator = 0;
+    slot.ticker = true;
+
+    // the window starts blank, the text enters from its right edge
+    slot.padTicker((COLUMNS_IN_CHARACTER * windowLength - 1) / SCROLL_COLUMNS_PER_CHARACTER);
+    slot.loadIntoFramebuffer();
 }
 
-void octoglow::front_display::display::pool() {
+uint8_t octoglow::front_display::display::appendTickerCharacters(const uint8_t slotNumber,
+                                                                 const uint8_t *const characterCodes) {
+    if (slotNumber >= _numberOfScrollingSlots or not _scrollingSlots[slotNumber].ticker) {
+        return 0;
+    }
 
-    if (scrollingWaitCounter == 300) {
+    _ScrollingSlot &slot = _scrollingSlots[slotNumber];
+    const uint8_t capacity = arena::size(slot.convertedText);
+    uint8_t *const text = arena::get(slot.convertedText);
+    uint8_t appended = 0;
 
-        for (auto &scrollingSlot : _scrollingSlots) {
-            scrollingSlot.scrollAndLoadIntoFramebuffer();
-        }
+    for (; characterCodes[appended] != 0 and slot.textLength != capacity; ++appended) {
+        const uint16_t index = slot.tickerHead + slot.textLength;
+        text[index < capacity ? index : index - capacity] = characterCodes[appended];
+        ++slot.textLength;
+    }
+
+    return appended;
+}
 
-        scrollingWaitCounter = 0;
+uint8_t octoglow::front_display::display::tickerFreeSpace(const uint8_t slotNumber) {
+    if (slotNumber >= _numberOfScrollingSlots or not _scrollingSlots[slotNumber].ticker) {
+        return 0;
     }
 
-    ++scrollingWaitCounter;
+    const _ScrollingSlot &slot = _scrollingSlots[slotNumber];
+    return arena::size(slot.convertedText) - slot.textLength;
+}
 
-    hd::displayPool();
+void octoglow::front_display::display::setScrollingSpeed(const uint8_t slotNumber, const uint8_t columnsPerSecond) {
+    if (slotNumber < _numberOfScrollingSlots) {
+        _scrollingSlots[slotNumber].speed = columnsPerSecond;
+    }
 }
 
-void octoglow::front_display::display::setBrightness(const uint8_t brightness) {
-    _brightness = brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness;
+void octoglow::front_display::display::configureScrollingSlots(const uint8_t numberOfSlots,
+                                                               const uint8_t *const capacities) {
+    for (auto &scrollingSlot : _scrollingSlots) {
+        scrollingSlot.clear();
+        scrollingSlot.maxTextLength = 0;
+    }
+
+    _numberOfScrollingSlots = numberOfSlots < scroll::MAX_NUMBER_OF_SLOTS
+                              ? numberOfSlots
+                              : scroll::MAX_NUMBER_OF_SLOTS;
+
+    for (uint8_t i = 0; i != _numberOfScrollingSlots; ++i) {
+        _scrollingSlots[i].maxTextLength = capacities[i];
+    }
 }
 
-void octoglow::front_display::display::drawGraphics(const uint8_t columnPosition,
-                                                    const uint8_t columnLength,
-                                                    const bool sumWithText,
-                                                    const uint8_t *const columnBuffer,
-                                                    const bool bufferInProgramSpace) {
-    for (uint8_t p = 0; p < columnLength; ++p) {
-        const uint8_t columnContent = bufferInProgramSpace
-                                      ? pgm_read_byte(columnBuffer + p)
-                                      : columnBuffer[p];
+/**
+ * Wire image bit of each dot of the grid, the bits are numbered from the MSB of the first byte.
+ */
+struct DotBitTable {
+    uint8_t bit[COLUMNS_IN_CHARACTER][ROWS_IN_CHARACTER];
 
-        if (sumWithText) {
+    constexpr DotBitTable() : bit() {
+        for (uint8_t i = 0; i != 8 * WIRE_IMAGE_BYTES_PER_GRID; ++i) {
+            const AnodeBit &anodeBit = anodeSequence[i];
+            if (anodeBit.column == UPPER_BAR_SEGMENT or anodeBit.rowMask == 0) {
+                continue;
+            }
+            for (uint8_t row = 0; row != ROWS_IN_CHARACTER; ++row) {
+                if (anodeBit.rowMask == (1 << row)) {
+                    bit[anodeBit.column][row] = i;
+                }
+            }
+        }
+    }
+};
+
+static const DotBitTable dotBitTable PROGMEM = DotBitTable();
+
+constexpr uint8_t UPPER_BAR_BIT = 8 * WIRE_IMAGE_BYTES_PER_GRID - 1;
+
+static_assert(UPPER_BAR_SEGMENT == anodeSequence[UPPER_BAR_BIT].column, "upper bar has to be the last bit");
+
+static inline void setWireImageBit(const uint8_t position, const uint8_t bit, const bool value) {
+    const uint8_t mask = 0x80 >> (bit % 8);
+    if (value) {
+        frozenGrid(position)[bit / 8] |= mask;
+    } else {
+        frozenGrid(position)[bit / 8] &= ~mask;
+    }
+}
+
+static void setWireImageColumn(const uint8_t position, const uint8_t column, const uint8_t content) {
+    for (uint8_t row = 0; row != ROWS_IN_CHARACTER; ++row) {
+        setWireImageBit(position, pgm_read_byte(&dotBitTable.bit[column][row]), content & (1 << row));
+    }
+}
+
+static uint8_t wireImageColumn(const uint8_t position, const uint8_t column) {
+    uint8_t content = 0;
+    for (uint8_t row = 0; row != ROWS_IN_CHARACTER; ++row) {
+        const uint8_t bit = pgm_read_byte(&dotBitTable.bit[column][row]);
+        if (frozenGrid(position)[bit / 8] & (0x80 >> (bit % 8))) {
+            content |= 1 << row;
+        }
+    }
+    return content;
+}
+
+/**
+ * Dots of the whole display, visited by DISSOLVE in the pseudo-random order of the 11-bit LFSR.
+ */
+constexpr uint16_t NUM_OF_DOTS = NUM_OF_CHARACTERS * COLUMNS_IN_CHARACTER * ROWS_IN_CHARACTER;
+constexpr uint16_t DISSOLVE_LFSR_PERIOD = 2047;
+constexpr uint16_t DISSOLVE_LFSR_TAPS = 0x500; // x^11 + x^9 + 1
+
+static_assert(NUM_OF_DOTS <= DISSOLVE_LFSR_PERIOD, "LFSR has to visit every dot");
+
+static constexpr uint16_t nextDissolveLfsr(const uint16_t lfsr) {
+    return (lfsr >> 1) ^ ((lfsr & 1) ? DISSOLVE_LFSR_TAPS : 0);
+}
+
+static constexpr bool isDissolveLfsrMaximal() {
+    uint16_t lfsr = 1;
+    for (uint16_t i = 1; i != DISSOLVE_LFSR_PERIOD; ++i) {
+        lfsr = nextDissolveLfsr(lfsr);
+        if (lfsr == 1) {
+            return false;
+        }
+    }
+    return nextDissolveLfsr(lfsr) == 1;
+}
+
+static_assert(isDissolveLfsrMaximal(), "LFSR period is too short");
+
+static uint16_t numberOfTransitionSteps(const uint8_t style) {
+    switch (static_cast<transition::Style>(style)) {
+        case transition::Style::SLIDE:
+            return COLUMNS_IN_CHARACTER;
+        case transition::Style::DISSOLVE:
+            return DISSOLVE_LFSR_PERIOD;
+        default:
+            return LINE_COLUMNS;
+    }
+}
+
+/**
+ * WIPE and UPPER_BAR_SWEEP: the column of both lines is switched to the new content. Grids are rebuilt whole
+ * once the edge has passed them; UPPER_BAR_SWEEP lights the upper bar segment over the edge meanwhile.
+ */
+static void wipeColumn(const uint8_t lineColumn, const bool sweep) {
+    for (uint8_t column = lineColumn; column < NUM_OF_COLUMNS; column += LINE_COLUMNS) {
+        const uint8_t position = column / COLUMNS_IN_CHARACTER;
+        const uint8_t columnInCharacter = column % COLUMNS_IN_CHARACTER;
+
+        if (columnInCharacter == COLUMNS_IN_CHARACTER - 1) {
+            composeGridImage(position, frozenGrid(position));
+            continue;
+        }
+
+        uint8_t composed[COLUMNS_IN_CHARACTER];
+        setWireImageColumn(position, columnInCharacter, composeCharacter(position, composed)[columnInCharacter]);
+
+        if (sweep and position < UPPER_BAR_LENGTH) {
+            setWireImageBit(position, UPPER_BAR_BIT, true);
+        }
+    }
+}
+
+/**
+ * SLIDE: the content of every grid moves left by one column and the next column of the new content enters
+ * from the right.
+ */
+static void slideGrids(const uint8_t step) {
+    for (uint8_t position = 0; position != NUM_OF_CHARACTERS; ++position) {
+        if (step == COLUMNS_IN_CHARACTER - 1) {
+            composeGridImage(position, frozenGrid(position));
+            continue;
+        }
+
+        for (uint8_t column = 0; column != COLUMNS_IN_CHARACTER - 1; ++column) {
+            setWireImageColumn(position, column, wireImageColumn(position, column + 1));
+        }
+
+        uint8_t composed[COLUMNS_IN_CHARACTER];
+        setWireImageColumn(position, COLUMNS_IN_CHARACTER - 1, composeCharacter(position, composed)[step]);
+    }
+}
+
+static void dissolveDot() {
+    const uint16_t lfsr = _transition.lfsr;
+    _transition.lfsr = nextDissolveLfsr(lfsr);
+
+    const uint16_t dot = lfsr - 1;
+    if (dot >= NUM_OF_DOTS) {
+        return;
+    }
+
+    const uint8_t position = dot / (COLUMNS_IN_CHARACTER * ROWS_IN_CHARACTER);
+    const uint8_t dotInCharacter = dot % (COLUMNS_IN_CHARACTER * ROWS_IN_CHARACTER);
+    const uint8_t column = dotInCharacter / ROWS_IN_CHARACTER;
+    const uint8_t row = dotInCharacter % ROWS_IN_CHARACTER;
+
+    uint8_t composed[COLUMNS_IN_CHARACTER];
+    setWireImageBit(position,
+                    pgm_read_byte(&dotBitTable.bit[column][row]),
+                    composeCharacter(position, composed)[column] & (1 << row));
+}
+
+static void advanceTransition(const uint8_t elapsedFrames) {
+    const uint16_t numberOfSteps = numberOfTransitionSteps(_transition.style);
+
+    _transition.elapsedFrames += elapsedFrames;
+    const uint16_t targetStep = _transition.elapsedFrames >= _transition.durationFrames
+                                ? numberOfSteps
+                                : static_cast<uint32_t>(numberOfSteps) * _transition.elapsedFrames
+                                  / _transition.durationFrames;
+
+    for (; _transition.step < targetStep; ++_transition.step) {
+        switch (static_cast<transition::Style>(_transition.style)) {
+            case transition::Style::SLIDE:
+                slideGrids(_transition.step);
+                break;
+            case transition::Style::DISSOLVE:
+                dissolveDot();
+                break;
+            default:
+                wipeColumn(_transition.step, _transition.style == static_cast<uint8_t>(transition::Style::UPPER_BAR_SWEEP));
+                break;
+        }
+    }
+
+    if (_transition.step == numberOfSteps) {
+        _transition.running = false;
+        arena::release(_transition.frozenImage);
+    }
+}
+
+void octoglow::front_display::display::stageFrame() {
+    _transition.running = false;
+    _transition.elapsedFrames = 0;
+
+    // a running transition is frozen in its current state
+    if (_transition.frozenImage == arena::INVALID_HANDLE) {
+        const arena::Handle frozenImage = arena::allocate(NUM_OF_CHARACTERS * WIRE_IMAGE_BYTES_PER_GRID);
+        if (frozenImage == arena::INVALID_HANDLE) {
+            return;
+        }
+
+        uint8_t *const image = arena::get(frozenImage);
+        for (uint8_t position = 0; position != NUM_OF_CHARACTERS; ++position) {
+            composeGridImage(position, image + WIRE_IMAGE_BYTES_PER_GRID * position);
+        }
+        _transition.frozenImage = frozenImage;
+    }
+
+    _transition.staging = true;
+}
+
+void octoglow::front_display::display::startTransition(const uint8_t style, const uint8_t duration) {
+    _transition.staging = false;
+    _transition.running = false;
+
+    if (_transition.frozenImage == arena::INVALID_HANDLE) {
+        return;
+    }
+
+    if (duration == 0 or style > static_cast<uint8_t>(transition::Style::UPPER_BAR_SWEEP)) {
+        arena::release(_transition.frozenImage);
+        return;
+    }
+
+    _transition.style = style;
+    _transition.durationFrames = static_cast<uint16_t>(duration) * transition::DURATION_UNIT;
+    _transition.elapsedFrames = 0;
+    _transition.step = 0;
+    _transition.lfsr = 1;
+    _transition.running = true;
+}
+
+void octoglow::front_display::display::clear() {
+    for (auto &scrollingSlot : _scrollingSlots) {
+        scrollingSlot.clear();
+    }
+
+    for (auto &chart : _charts) {
+        chart.clear();
+    }
+
+    for (auto &numberWidget : _numberWidgets) {
+        numberWidget.width = 0;
+    }
+
+    arena::release(_textLayer);
+    arena::release(_overlay.columns);
+    _overlay.framesLeft = 0;
+
+    memset(_blinkingCells, 0, CELL_SET_BYTES);
+    memset(_invertedCells, 0, CELL_SET_BYTES);
+    memset(_dimmedCells, 0, CELL_SET_BYTES);
+
+    _upperBarBuffer = 0;
+
+    memset(_frameBuffer, 0,
+           COLUMNS_IN_CHARACTER * NUM_OF_CHARACTERS);
+}
+
+void octoglow::front_display::display::pool() {
+    // the low byte is read atomically and suffices for the difference
+    const uint8_t frameTicks = static_cast<uint8_t>(_frameTicks);
+    const uint8_t elapsedFrames = frameTicks - lastFrameTicks;
+
+    if (elapsedFrames == 0) {
+        return;
+    }
+
+    lastFrameTicks = frameTicks;
+
+    for (uint8_t i = 0; i != _numberOfScrollingSlots; ++i) {
+        _scrollingSlots[i].advance(elapsedFrames);
+    }
+
+    for (auto &numberWidget : _numberWidgets) {
+        numberWidget.count(elapsedFrames);
+    }
+
+    if (_transition.running) {
+        advanceTransition(elapsedFrames);
+    } else if (_transition.staging) {
+        _transition.elapsedFrames += elapsedFrames;
+        if (_transition.elapsedFrames >= transition::STAGING_TIMEOUT) {
+            startTransition(0, 0);
+        }
+    }
+
+    if (_overlay.framesLeft != 0) {
+        if (elapsedFrames < _overlay.framesLeft) {
+            _overlay.framesLeft -= elapsedFrames;
+        } else {
+            showOverlay(0, 0, 0, 0, nullptr);
+        }
+    }
+}
+
+void octoglow::front_display::display::setBrightness(const uint8_t brightness) {
+    if (brightness & brightness::FINE_LEVEL_FLAG) {
+        const uint8_t level = brightness & ~brightness::FINE_LEVEL_FLAG;
+        _brightness = level > MAX_FINE_BRIGHTNESS ? MAX_FINE_BRIGHTNESS : level;
+    } else {
+        const uint8_t level = brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness;
+        _brightness = level * MAX_FINE_BRIGHTNESS / MAX_BRIGHTNESS;
+    }
+}
+
+void octoglow::front_display::display::drawGraphics(const uint8_t columnPosition,
+                                                    const uint8_t columnLength,
+                                                    const bool sumWithText,
+                                                    const uint8_t *const columnBuffer,
+                                                    const bool bufferInProgramSpace) {
+    for (uint8_t p = 0; p < columnLength; ++p) {
+        const uint8_t columnContent = bufferInProgramSpace
+                                      ? pgm_read_byte(columnBuffer + p)
+                                      : columnBuffer[p];
+
+        if (sumWithText) {
             _frameBuffer[columnPosition + p] |= columnContent;
         } else {
             _frameBuffer[columnPosition + p] = columnContent;
@@ -249,6 +1108,476 @@ void octoglow::front_display::display::drawGraphics(const uint8_t columnPosition
     }
 }
 
+/**
+ * Walks through the frame patch segments and, if apply is set, writes them into the framebuffer.
+ * @return false if the patch is malformed or reaches past the display
+ */
+static bool walkFramePatch(const uint8_t *const patch, const uint8_t patchLength, const bool apply) {
+    uint8_t column = 0;
+    uint8_t idx = 0;
+
+    while (idx != patchLength) {
+        // column offset, header and at least one data byte
+        if (patchLength - idx < 3) {
+            return false;
+        }
+
+        const uint16_t startColumn = column + patch[idx];
+        const uint8_t header = patch[idx + 1];
+        const uint8_t runLength = (header & patch::RUN_LENGTH_MASK) + 1;
+        const bool repeated = header & patch::REPEAT_FLAG;
+        const uint8_t dataLength = repeated ? 1 : runLength;
+        idx += 2;
+
+        if (startColumn + runLength > NUM_OF_COLUMNS or patchLength - idx < dataLength) {
+            return false;
+        }
+
+        if (apply) {
+            for (uint8_t c = 0; c != runLength; ++c) {
+                const uint8_t value = patch[idx + (repeated ? 0 : c)];
+                if (header & patch::XOR_FLAG) {
+                    _frameBuffer[startColumn + c] ^= value;
+                } else {
+                    _frameBuffer[startColumn + c] = value;
+                }
+            }
+        }
+
+        column = startColumn + runLength;
+        idx += dataLength;
+    }
+
+    return true;
+}
+
+bool octoglow::front_display::display::patchFrame(const uint8_t *const patch, const uint8_t patchLength) {
+    if (not walkFramePatch(patch, patchLength, false)) {
+        return false;
+    }
+
+    walkFramePatch(patch, patchLength, true);
+    return true;
+}
+
+void octoglow::front_display::display::uploadGlyph(const uint8_t glyphId,
+                                                   const uint8_t width,
+                                                   const uint8_t *const columns) {
+    if (glyphId >= glyph::MAX_NUMBER_OF_GLYPHS) {
+        return;
+    }
+
+    arena::Handle &handle = _userGlyphs[glyphId];
+    arena::release(handle);
+
+    if (width == 0) {
+        return;
+    }
+
+    handle = arena::allocate(width);
+
+    if (handle != arena::INVALID_HANDLE) {
+        memcpy(arena::get(handle), columns, width);
+    }
+}
+
+void octoglow::front_display::display::drawGlyph(const uint8_t columnPosition,
+                                                 const uint8_t glyphId,
+                                                 const bool sumWithText) {
+    if (glyphId >= glyph::MAX_NUMBER_OF_GLYPHS or columnPosition >= NUM_OF_COLUMNS) {
+        return;
+    }
+
+    const arena::Handle handle = _userGlyphs[glyphId];
+    if (handle == arena::INVALID_HANDLE) {
+        return;
+    }
+
+    const uint8_t width = arena::size(handle);
+    drawGraphics(columnPosition,
+                 width < NUM_OF_COLUMNS - columnPosition ? width : NUM_OF_COLUMNS - columnPosition,
+                 sumWithText,
+                 arena::get(handle));
+}
+
+void octoglow::front_display::display::writeTextLayer(const uint8_t position,
+                                                      const uint8_t maxLength,
+                                                      const uint8_t *const characterCodes) {
+    if (position >= NUM_OF_CHARACTERS) {
+        return;
+    }
+
+    const uint8_t length = maxLength < NUM_OF_CHARACTERS - position ? maxLength : NUM_OF_CHARACTERS - position;
+
+    if (_textLayer == arena::INVALID_HANDLE) {
+        if (length == 0 or characterCodes[0] == 0) {
+            return;
+        }
+
+        _textLayer = arena::allocate(NUM_OF_CHARACTERS);
+        if (_textLayer == arena::INVALID_HANDLE) {
+            return;
+        }
+        memset(arena::get(_textLayer), 0, NUM_OF_CHARACTERS);
+    }
+
+    uint8_t *const cells = arena::get(_textLayer);
+    bool textEnded = false;
+    for (uint8_t i = 0; i != length; ++i) {
+        textEnded = textEnded or characterCodes[i] == 0;
+        cells[position + i] = textEnded ? 0 : characterCodes[i];
+    }
+
+    bool empty = true;
+    for (uint8_t i = 0; i != NUM_OF_CHARACTERS and empty; ++i) {
+        empty = cells[i] == 0;
+    }
+    if (empty) {
+        arena::release(_textLayer);
+    }
+}
+
+void octoglow::front_display::display::setTextLayerBlending(const uint8_t blending) {
+    if (blending > static_cast<uint8_t>(layer::Blending::MASK)) {
+        return;
+    }
+
+    _textLayerBlending = blending;
+}
+
+void octoglow::front_display::display::showOverlay(const uint8_t columnPosition,
+                                                   const uint8_t width,
+                                                   const uint8_t blending,
+                                                   const uint8_t duration,
+                                                   const uint8_t *const columns) {
+    arena::release(_overlay.columns);
+    _overlay.framesLeft = 0;
+
+    if (columnPosition < NUM_OF_COLUMNS and width != 0) {
+        const uint8_t clippedWidth = width < NUM_OF_COLUMNS - columnPosition ? width : NUM_OF_COLUMNS - columnPosition;
+        _overlay.columns = arena::allocate(clippedWidth);
+
+        if (_overlay.columns != arena::INVALID_HANDLE) {
+            memcpy(arena::get(_overlay.columns), columns, clippedWidth);
+            _overlay.columnPosition = columnPosition;
+            _overlay.blending = blending;
+            _overlay.framesLeft = static_cast<uint16_t>(duration) * layer::DURATION_UNIT;
+        }
+    }
+}
+
+static inline void setCellInSet(uint8_t *const cellSet, const uint8_t position, const bool value) {
+    const uint8_t bit = 1 << (position % 8);
+    if (value) {
+        cellSet[position / 8] |= bit;
+    } else {
+        cellSet[position / 8] &= ~bit;
+    }
+}
+
+void octoglow::front_display::display::setCellAttributes(const uint8_t position,
+                                                         const uint8_t length,
+                                                         const uint8_t attributes) {
+    for (uint8_t p = position; p < position + length and p < NUM_OF_CHARACTERS; ++p) {
+        setCellInSet(_blinkingCells, p, attributes & attribute::BLINK_FLAG);
+        setCellInSet(_invertedCells, p, attributes & attribute::INVERSE_FLAG);
+        setCellInSet(_dimmedCells, p, attributes & attribute::DIM_FLAG);
+    }
+}
+
+/**
+ * DIFF_BARS columns of the scaled differences -3 to 3, the bar grows from the middle row.
+ */
+static const uint8_t DIFF_BAR_COLUMNS[] PROGMEM = {
+        0b1111000, 0b0111000, 0b0011000, 0b0001000, 0b0001100, 0b0001110, 0b0001111,
+};
+
+constexpr int8_t DIFF_BAR_MAX_ROWS = 3;
+constexpr int8_t TWO_LINES_MAX_ROWS = 7;
+constexpr uint8_t SPARKLINE_MAX_ROW = 6;
+
+constexpr uint8_t DIFF_BAR_NO_VALUE_COLUMN = 0b1000001;
+constexpr uint8_t TWO_LINES_NO_VALUE_UPPER_COLUMN = 0b0000001;
+constexpr uint8_t TWO_LINES_NO_VALUE_LOWER_COLUMN = 0b1000000;
+constexpr uint8_t TWO_LINES_NEWEST_UPPER_COLUMN = 0b1000000;
+constexpr uint8_t TWO_LINES_NEWEST_LOWER_COLUMN = 0b0000001;
+
+/**
+ * Difference of the samples divided by the scale, rounded to the nearest row and limited to the given number of rows.
+ */
+static int8_t scaledDifference(const int8_t sample, const int8_t newest, const uint8_t scale, const int8_t maxRows) {
+    const int16_t difference = static_cast<int16_t>(sample) - newest;
+    const uint16_t rows = ((difference < 0 ? -difference : difference) + scale / 2) / scale;
+    const int8_t limited = rows > static_cast<uint16_t>(maxRows) ? maxRows : static_cast<int8_t>(rows);
+    return difference < 0 ? -limited : limited;
+}
+
+void _Chart::clear() {
+    width = 0;
+    numberOfSamples = 0;
+    arena::release(samples);
+}
+
+void _Chart::renderColumn(const uint8_t column, const int8_t newest) {
+    uint8_t upper = 0;
+    uint8_t lower = 0;
+
+    if (column >= this->width - this->numberOfSamples) {
+        const int8_t sample = static_cast<int8_t>(arena::get(this->samples)[column]);
+        const bool isNewest = column == this->width - 1;
+        const bool noValue = sample == chart::NO_VALUE or newest == chart::NO_VALUE;
+
+        switch (static_cast<chart::Style>(this->style)) {
+            case chart::Style::DIFF_BARS:
+                if (noValue) {
+                    upper = DIFF_BAR_NO_VALUE_COLUMN;
+                } else {
+                    const int8_t rows = scaledDifference(sample, newest, this->scale, DIFF_BAR_MAX_ROWS);
+                    upper = pgm_read_byte(&DIFF_BAR_COLUMNS[rows + DIFF_BAR_MAX_ROWS]);
+                }
+                break;
+            case chart::Style::SPARKLINE:
+                if (sample != chart::NO_VALUE) {
+                    const uint8_t row = sample < 0 ? 0 : sample / this->scale;
+                    upper = 0b1000000 >> (row > SPARKLINE_MAX_ROW ? SPARKLINE_MAX_ROW : row);
+                }
+                break;
+            case chart::Style::TWO_LINES:
+                if (noValue) {
+                    upper = TWO_LINES_NO_VALUE_UPPER_COLUMN;
+                    lower = TWO_LINES_NO_VALUE_LOWER_COLUMN;
+                } else if (isNewest) {
+                    upper = TWO_LINES_NEWEST_UPPER_COLUMN;
+                    lower = TWO_LINES_NEWEST_LOWER_COLUMN;
+                } else {
+                    const int8_t rows = scaledDifference(sample, newest, this->scale, TWO_LINES_MAX_ROWS);
+                    // the upper bar grows up from the bottom row, the lower one down from the top row
+                    if (rows > 0) {
+                        upper = static_cast<uint8_t>(0x7f << (TWO_LINES_MAX_ROWS - rows)) & 0x7f;
+                    } else {
+                        lower = (1 << -rows) - 1;
+                    }
+                }
+                break;
+        }
+    }
+
+    _frameBuffer[this->columnPosition + column] = upper;
+    if (static_cast<chart::Style>(this->style) == chart::Style::TWO_LINES) {
+        _frameBuffer[this->columnPosition + LINE_COLUMNS + column] = lower;
+    }
+}
+
+void _Chart::loadIntoFramebuffer() {
+    if (this->width == 0) {
+        return;
+    }
+
+    const int8_t newest = static_cast<int8_t>(arena::get(this->samples)[this->width - 1]);
+
+    for (uint8_t c = 0; c != this->width; ++c) {
+        this->renderColumn(c, newest);
+    }
+}
+
+void _Chart::append(const int8_t sample) {
+    if (this->width == 0) {
+        return;
+    }
+
+    uint8_t *const stored = arena::get(this->samples);
+    memmove(stored, stored + 1, this->width - 1);
+    stored[this->width - 1] = static_cast<uint8_t>(sample);
+
+    if (this->numberOfSamples != this->width) {
+        ++this->numberOfSamples;
+    }
+
+    if (static_cast<chart::Style>(this->style) == chart::Style::SPARKLINE) {
+        uint8_t *const window = _frameBuffer + this->columnPosition;
+        memmove(window, window + 1, this->width - 1);
+        this->renderColumn(this->width - 1, sample);
+    } else {
+        this->loadIntoFramebuffer();
+    }
+}
+
+void octoglow::front_display::display::configureChart(const uint8_t chartId,
+                                                      const uint8_t columnPosition,
+                                                      const uint8_t width,
+                                                      const uint8_t style,
+                                                      const uint8_t scale) {
+    if (chartId >= chart::MAX_NUMBER_OF_CHARTS) {
+        return;
+    }
+
+    _Chart &selected = _charts[chartId];
+    selected.clear();
+
+    const uint8_t endColumn = static_cast<chart::Style>(style) == chart::Style::TWO_LINES
+                              ? LINE_COLUMNS
+                              : NUM_OF_COLUMNS;
+
+    if (width == 0
+        or style > static_cast<uint8_t>(chart::Style::TWO_LINES)
+        or columnPosition >= endColumn
+        or width > endColumn - columnPosition) {
+        return;
+    }
+
+    selected.samples = arena::allocate(width);
+    if (selected.samples == arena::INVALID_HANDLE) {
+        return;
+    }
+
+    selected.columnPosition = columnPosition;
+    selected.width = width;
+    selected.style = style;
+    selected.scale = scale == 0 ? 1 : scale;
+
+    selected.loadIntoFramebuffer();
+}
+
+void octoglow::front_display::display::setChartSamples(const uint8_t chartId,
+                                                       const uint8_t numberOfSamples,
+                                                       const int8_t *const samples) {
+    if (chartId >= chart::MAX_NUMBER_OF_CHARTS or _charts[chartId].width == 0) {
+        return;
+    }
+
+    _Chart &selected = _charts[chartId];
+    const uint8_t kept = numberOfSamples < selected.width ? numberOfSamples : selected.width;
+
+    memcpy(arena::get(selected.samples) + selected.width - kept, samples + numberOfSamples - kept, kept);
+    selected.numberOfSamples = kept;
+
+    selected.loadIntoFramebuffer();
+}
+
+void octoglow::front_display::display::appendChartSample(const uint8_t chartId, const int8_t sample) {
+    if (chartId < chart::MAX_NUMBER_OF_CHARTS) {
+        _charts[chartId].append(sample);
+    }
+}
+
+/**
+ * Counting widget moves by this fraction of the remaining difference every frame.
+ */
+constexpr int32_t COUNTING_DIVISOR = 8;
+
+void _NumberWidget::render() const {
+    if (this->width == 0) {
+        return;
+    }
+
+    uint8_t codes[widget::MAX_WIDTH + 1];
+    const uint8_t numberLength = this->unit != 0 ? this->width - 1 : this->width;
+
+    uint8_t cell = numberLength;
+    bool overflow = false;
+    const auto put = [&](const uint8_t code) {
+        if (cell == 0) {
+            overflow = true;
+        } else {
+            codes[--cell] = code;
+        }
+    };
+
+    // the magnitude of INT32_MIN doesn't fit int32_t
+    uint32_t magnitude = this->shownValue < 0
+                         ? -static_cast<uint32_t>(this->shownValue)
+                         : static_cast<uint32_t>(this->shownValue);
+    // every iteration takes a cell, so the loop ends within the width whatever the decimals are
+    uint8_t digits = 0;
+    do {
+        if (digits == this->decimals and digits != 0) {
+            put('.');
+            if (magnitude == 0 and cell == 0) {
+                break;
+            }
+        }
+        put('0' + magnitude % 10);
+        magnitude /= 10;
+        ++digits;
+    } while ((magnitude != 0 or digits <= this->decimals) and not overflow);
+
+    const uint8_t sign = this->shownValue < 0
+                         ? '-'
+                         : ((this->flags & widget::PLUS_SIGN_FLAG) and this->shownValue > 0 ? '+' : 0);
+
+    if (this->flags & widget::LEADING_ZEROS_FLAG) {
+        while (cell > (sign != 0 ? 1 : 0)) {
+            put('0');
+        }
+    }
+    if (sign != 0) {
+        put(sign);
+    }
+
+    memset(codes, overflow ? '#' : ' ', overflow ? numberLength : cell);
+    codes[numberLength] = this->unit;
+    codes[this->width] = 0;
+
+    writeStaticCharacters(this->position, this->width, codes);
+}
+
+void _NumberWidget::count(const uint8_t elapsedFrames) {
+    if (this->width == 0 or this->shownValue == this->value) {
+        return;
+    }
+
+    for (uint8_t frame = 0; frame != elapsedFrames and this->shownValue != this->value; ++frame) {
+        // divided separately, so the difference of the extreme values doesn't overflow
+        int32_t step = this->value / COUNTING_DIVISOR - this->shownValue / COUNTING_DIVISOR;
+        if (step == 0) {
+            step = this->value > this->shownValue ? 1 : -1;
+        }
+        this->shownValue += step;
+    }
+
+    render();
+}
+
+void octoglow::front_display::display::configureNumberWidget(const uint8_t widgetId,
+                                                             const uint8_t position,
+                                                             const uint8_t width,
+                                                             const uint8_t decimals,
+                                                             const uint8_t flags,
+                                                             const uint16_t unitCodePoint) {
+    if (widgetId >= widget::MAX_NUMBER_OF_WIDGETS) {
+        return;
+    }
+
+    _NumberWidget &numberWidget = _numberWidgets[widgetId];
+    const uint8_t unit = unitCodePoint == 0
+                         ? 0
+                         : (unitCodePoint >= ' ' and unitCodePoint < 0x80 ? unitCodePoint : _characterCodeOf(unitCodePoint));
+    const uint8_t numberLength = unit != 0 ? width - 1 : width;
+    const bool fits = position < NUM_OF_CHARACTERS
+                      and width <= NUM_OF_CHARACTERS - position
+                      and width <= widget::MAX_WIDTH
+                      and width > (unit != 0 ? 1 : 0)
+                      and decimals <= widget::MAX_DECIMALS
+                      and decimals < numberLength;
+
+    numberWidget = {position, static_cast<uint8_t>(fits ? width : 0), decimals, flags, unit, 0, 0};
+    numberWidget.render();
+}
+
+void octoglow::front_display::display::setWidgetValue(const uint8_t widgetId, const int32_t value) {
+    if (widgetId >= widget::MAX_NUMBER_OF_WIDGETS) {
+        return;
+    }
+
+    _NumberWidget &numberWidget = _numberWidgets[widgetId];
+    numberWidget.value = value;
+
+    if (not(numberWidget.flags & widget::COUNTING_FLAG)) {
+        numberWidget.shownValue = value;
+        numberWidget.render();
+    }
+}
+
 void octoglow::front_display::display::setUpperBarContent(const uint32_t content) {
     _upperBarBuffer = 0b11111111111111111111ul & content;
 }
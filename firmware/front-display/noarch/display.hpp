@@ -1,20 +1,64 @@
 #pragma once
 
+#include "arena.hpp"
+
 #include <inttypes.h>
 
 namespace octoglow::front_display::display {
 
     constexpr uint8_t NUM_OF_CHARACTERS = 40;
     constexpr uint8_t COLUMNS_IN_CHARACTER = 5;
+    constexpr uint8_t ROWS_IN_CHARACTER = 7;
 
+    /**
+     * Legacy coarse brightness levels, mapped evenly onto the fine ones.
+     */
     constexpr uint8_t MAX_BRIGHTNESS = 5;
 
+    /**
+     * Fine brightness levels are perceptually spaced, 0 is off.
+     */
+    constexpr uint8_t MAX_FINE_BRIGHTNESS = 63;
+
+    /**
+     * Number of complete refreshes of all grids per second. The refresh is driven by the hardware timer.
+     */
+    constexpr uint8_t FRAME_RATE = 100; // Hz
+
+    /**
+     * Number of bytes of the anode part of the scan chain shifted out for one grid: 35 dots,
+     * the upper bar segment and 4 dummy bits.
+     */
+    constexpr uint8_t WIRE_IMAGE_BYTES_PER_GRID = 5;
+
+    /**
+     * Blinking characters are shown and blanked for this many frames in turn.
+     */
+    constexpr uint8_t BLINK_HALF_PERIOD = FRAME_RATE / 4;
+
+    constexpr uint8_t CELL_SET_BYTES = (NUM_OF_CHARACTERS + 7) / 8;
+
+    /**
+     * Bits of the wire image byte which drive the dots; the other ones are the upper bar segment and the dummy bits.
+     */
+    constexpr uint8_t wireImageDotMask(const uint8_t byteIndex) {
+        return byteIndex == 2 ? 0x33 : byteIndex == 4 ? 0xfe : 0xff;
+    }
+
     void init();
 
     void clear();
 
+    /**
+     * Performs the time-based work (scrolling etc.) for the frames refreshed since the last call.
+     * Has to be called from the main loop.
+     */
     void pool();
 
+    /**
+     * Sets the coarse brightness 0 - MAX_BRIGHTNESS or, if protocol::brightness::FINE_LEVEL_FLAG is set,
+     * the fine brightness 0 - MAX_FINE_BRIGHTNESS.
+     */
     void setBrightness(uint8_t brightness);
 
     void writeStaticText(uint8_t position,
@@ -22,18 +66,63 @@ namespace octoglow::front_display::display {
                          const char *text,
                          bool textInProgramSpace = false);
 
+    /**
+     * Same as writeStaticText(), the text is already converted to character codes and terminated by zero.
+     */
+    void writeStaticCharacters(uint8_t position, uint8_t maxLength, const uint8_t *characterCodes);
+
     inline void writeStaticText_P(const uint8_t position,
                                   const uint8_t maxLength,
                                   const char *const progmemText) {
         writeStaticText(position, maxLength, const_cast<char *>(progmemText), true);
     }
 
+    /**
+     * Scrolls the text in the window with protocol::scroll::DEFAULT_SPEED. If the text fits the window, it is
+     * written as static text and the slot is disabled.
+     */
     void writeScrollingText(uint8_t slotNumber,
                             uint8_t position,
                             uint8_t windowLength,
                             const char *text,
                             bool textInProgramSpace = false);
 
+    /**
+     * Same as writeScrollingText(), the text is already converted to character codes and terminated by zero.
+     */
+    void writeScrollingCharacters(uint8_t slotNumber,
+                                  uint8_t position,
+                                  uint8_t windowLength,
+                                  const uint8_t *characterCodes);
+
+    void setScrollingSpeed(uint8_t slotNumber, uint8_t columnsPerSecond);
+
+    /**
+     * Disables all scrolling slots and sets up the given number of them, with the maximal text length of each one.
+     * The converted texts are allocated from the shared arena only when written, so the sum of the capacities
+     * may exceed the arena size.
+     */
+    void configureScrollingSlots(uint8_t numberOfSlots, const uint8_t *capacities);
+
+    /**
+     * Switches the slot to the ticker mode: the window scrolls continuously through the text appended with
+     * appendTickerCharacters(), without restarting. The slot capacity is allocated at once and used as a circular
+     * buffer; characters are reclaimed as soon as they leave the window. When the text runs out, blanks are scrolled
+     * in, so the appended text always enters from the right edge.
+     */
+    void startTicker(uint8_t slotNumber, uint8_t position, uint8_t windowLength, uint8_t columnsPerSecond);
+
+    /**
+     * Appends the zero-terminated character codes to the ticker, truncated to its free space.
+     * @return number of characters appended
+     */
+    uint8_t appendTickerCharacters(uint8_t slotNumber, const uint8_t *characterCodes);
+
+    /**
+     * @return number of characters which can be appended to the ticker, 0 if the slot is not in the ticker mode
+     */
+    uint8_t tickerFreeSpace(uint8_t slotNumber);
+
     inline void writeScrollingText_P(const uint8_t slotNumber,
                                      const uint8_t position,
                                      const uint8_t windowLength,
@@ -57,37 +146,327 @@ namespace octoglow::front_display::display {
 
     void setUpperBarContent(uint32_t content);
 
+    /**
+     * Applies the list of segments described in protocol::patch to the framebuffer. The whole patch is validated
+     * first, a malformed one or one reaching past the display is not applied at all.
+     * @return false if the patch was rejected
+     */
+    bool patchFrame(const uint8_t *patch, uint8_t patchLength);
+
+    /**
+     * Stores the columns of the user glyph, replacing the previous one with the same id. Zero width removes
+     * the glyph. If there is not enough space in the arena, the glyph is left removed.
+     */
+    void uploadGlyph(uint8_t glyphId, uint8_t width, const uint8_t *columns);
+
+    /**
+     * Draws the whole user glyph starting at the given column, clipped at the end of the display.
+     */
+    void drawGlyph(uint8_t columnPosition, uint8_t glyphId, bool sumWithText);
+
+    /**
+     * Sets up the chart in the given columns and clears its samples. Zero width disables the chart.
+     * A chart which doesn't fit the display, or the upper line for chart::Style::TWO_LINES, or whose samples
+     * don't fit the arena, is left disabled.
+     * @param style protocol::chart::Style
+     * @param scale sample units per row, 0 is treated as 1
+     */
+    void configureChart(uint8_t chartId, uint8_t columnPosition, uint8_t width, uint8_t style, uint8_t scale);
+
+    /**
+     * Replaces the samples of the chart and redraws it. Only the newest width samples are kept.
+     */
+    void setChartSamples(uint8_t chartId, uint8_t numberOfSamples, const int8_t *samples);
+
+    /**
+     * Adds the sample as the newest one, dropping the oldest one if the chart is full, and redraws the chart.
+     */
+    void appendChartSample(uint8_t chartId, int8_t sample);
+
+    /**
+     * Writes the character codes into the cells of the text layer, the cells up to maxLength after the text
+     * become transparent. The layer takes NUM_OF_CHARACTERS bytes of the arena while any of its cells is set.
+     */
+    void writeTextLayer(uint8_t position, uint8_t maxLength, const uint8_t *characterCodes);
+
+    /**
+     * @param blending protocol::layer::Blending
+     */
+    void setTextLayerBlending(uint8_t blending);
+
+    /**
+     * Replaces the overlay with the given columns, clipped at the end of the display. Zero width removes it.
+     * The overlay is removed by pool() when its time runs out.
+     * @param blending protocol::layer::Blending
+     * @param duration in units of protocol::layer::DURATION_UNIT frames, 0 if the overlay doesn't expire
+     */
+    void showOverlay(uint8_t columnPosition, uint8_t width, uint8_t blending, uint8_t duration, const uint8_t *columns);
+
+    /**
+     * Sets up the widget and shows zero in it. A widget which doesn't fit the display or
+     * protocol::widget::MAX_WIDTH, or has no space for a digit before the decimal point, is left disabled.
+     * If only the point fits before the decimals, the integer zero is left out.
+     * @param flags protocol::widget flags
+     * @param unitCodePoint Unicode code point of the unit, shown in the last character, 0 if there is no unit
+     */
+    void configureNumberWidget(uint8_t widgetId,
+                               uint8_t position,
+                               uint8_t width,
+                               uint8_t decimals,
+                               uint8_t flags,
+                               uint16_t unitCodePoint);
+
+    /**
+     * Shows the value, or with protocol::widget::COUNTING_FLAG makes pool() count the shown value towards it.
+     */
+    void setWidgetValue(uint8_t widgetId, int32_t value);
+
+    /**
+     * Freezes the displayed image. The following changes are made to the framebuffer and the layers only,
+     * until startTransition() shows them or pool() does after protocol::transition::STAGING_TIMEOUT frames.
+     * The frozen image takes NUM_OF_CHARACTERS * WIRE_IMAGE_BYTES_PER_GRID bytes of the arena; if they aren't
+     * available, nothing is frozen and the changes are shown at once.
+     */
+    void stageFrame();
+
+    /**
+     * Changes the displayed image into the current content over the given time, the steps are made by pool().
+     * Zero duration or an unknown style shows the content at once.
+     * @param style protocol::transition::Style
+     * @param duration in units of protocol::transition::DURATION_UNIT frames
+     */
+    void startTransition(uint8_t style, uint8_t duration);
+
+    /**
+     * Replaces the attributes of the characters with the protocol::attribute flags.
+     */
+    void setCellAttributes(uint8_t position, uint8_t length, uint8_t attributes);
+
+    /**
+     * Looks up the character code of the non-ASCII code point in constant time. Code points starting with
+     * protocol::glyph::FIRST_CODE_POINT refer to the user glyphs.
+     * @return the character code or INVALID_CHARACTER_CODE if there is no glyph for it
+     */
+    uint8_t _characterCodeOf(uint16_t codePoint);
+
+    /**
+     * Incremental UTF-8 decoder, fed one byte at a time, so the text can be converted while it is being received.
+     * Zero-initialized decoder is ready for the first byte.
+     */
+    struct Utf8Decoder {
+        uint16_t codePoint;
+        uint8_t pendingBytes;
+        bool representable;
+
+        /**
+         * @param codes receives the character codes completed by the byte. A byte breaking off a sequence completes
+         * two of them: INVALID_CHARACTER_CODE for the truncated sequence and its own one.
+         * @return number of character codes written to codes, up to 2
+         */
+        uint8_t decode(uint8_t byte, uint8_t *codes);
+    };
+
+    /**
+     * Converts the zero-terminated UTF-8 text into the zero-terminated character codes, in place.
+     */
+    void convertUtf8InPlace(uint8_t *text);
+
+    /**
+     * Decodes the UTF-8 string and calls the callback with the font character code of each character.
+     * Malformed and truncated sequences are reported as INVALID_CHARACTER_CODE and never read past the terminating zero.
+     */
     void _forEachUtf8character(const char *str,
                                bool stringInProgramSpace,
                                uint8_t maxLength,
                                void *userData,
                                void (*callback)(void *, uint8_t, uint8_t));
 
+    /**
+     * Builds the anode bits of the grid, in the order they are shifted into the driver chain, MSB first,
+     * from the framebuffer, the layers blended over it and the upper bar. While staging or transition
+     * they are copied from the frozen image instead. Called by hd::displayPool() for every grid.
+     */
+    void _buildGridImage(uint8_t position, uint8_t *image);
+
     extern uint8_t _frameBuffer[];
 
     extern uint32_t _upperBarBuffer;
 
+    /**
+     * Arena block with the character codes of the text layer cells, 0 is a transparent cell.
+     * INVALID_HANDLE if all cells are transparent.
+     */
+    extern arena::Handle _textLayer;
+
+    /**
+     * Sets of the character positions with the attribute, bit position % 8 of byte position / 8.
+     * They are applied by hd::displayPool() while the grid is shifted out, after _buildGridImage().
+     */
+    extern uint8_t _blinkingCells[CELL_SET_BYTES];
+    extern uint8_t _invertedCells[CELL_SET_BYTES];
+    extern uint8_t _dimmedCells[CELL_SET_BYTES];
+
+    inline bool _isCellInSet(const uint8_t *const cellSet, const uint8_t position) {
+        return cellSet[position / 8] & (1 << (position % 8));
+    }
+
+    extern uint8_t _textLayerBlending;
+
+    struct _Overlay {
+        uint8_t columnPosition;
+        uint8_t blending;
+        uint16_t framesLeft; // 0 if the overlay doesn't expire
+        arena::Handle columns; // INVALID_HANDLE if there is no overlay
+    };
+
+    extern _Overlay _overlay;
+
+    /**
+     * The transition changes the frozen image step by step, while the content is already in the framebuffer.
+     * The frozen image is displayed instead of the content meanwhile and released at the end.
+     */
+    struct _Transition {
+        uint8_t style;
+        bool staging;
+        bool running;
+        uint16_t durationFrames;
+        uint16_t elapsedFrames; // also since stageFrame() while staging
+        uint16_t step; // number of steps made
+        uint16_t lfsr; // next dot of DISSOLVE
+        arena::Handle frozenImage; // wire image of all grids, INVALID_HANDLE unless staging or transition
+    };
+
+    extern _Transition _transition;
+
+    /**
+     * Current fine brightness level.
+     */
     extern uint8_t _brightness;
 
+    /**
+     * Incremented by the refresh interrupt after every complete frame. It is the time base of the device,
+     * in units of 1 / FRAME_RATE s.
+     */
+    extern volatile uint16_t _frameTicks;
+
     struct _ScrollingSlot {
 
         uint8_t startPosition;
         uint8_t length;
 
+        /**
+         * Index of the first visible column in the looped text column stream.
+         */
         uint16_t currentShift;
 
         uint8_t textLength;
-        const uint8_t maxTextLength;
-        uint8_t *const convertedText;
+        uint8_t maxTextLength;
+        arena::Handle convertedText;
+
+        uint8_t speed; // columns per second
+        uint8_t speedAccumulator;
+
+        /**
+         * In the ticker mode convertedText is a circular buffer of the slot capacity, textLength characters
+         * from tickerHead on. currentShift counts the columns of the first character already scrolled out.
+         */
+        bool ticker;
+        uint8_t tickerHead;
 
         void clear();
 
+        /**
+         * Renders the whole window at the current shift.
+         */
+        void loadIntoFramebuffer();
+
+        /**
+         * Moves the window content by one column and renders only the newly exposed column.
+         */
         void scrollAndLoadIntoFramebuffer();
+
+        /**
+         * Scrolls by as many columns as the slot's speed gives for the elapsed frames.
+         */
+        void advance(uint8_t elapsedFrames);
+
+        /**
+         * Appends blanks to the ticker text until it reaches the character at the given offset.
+         */
+        void padTicker(uint8_t characterOffset);
+
+    private:
+        uint16_t streamLength() const;
+
+        uint8_t columnAt(uint16_t streamColumn) const;
+
+        void scrollTicker();
     };
 
     extern _ScrollingSlot _scrollingSlots[];
 
+    struct _Chart {
+        uint8_t columnPosition;
+        uint8_t width; // 0 if the chart is disabled
+        uint8_t style;
+        uint8_t scale;
+
+        /**
+         * Number of samples stored at the end of the sample block, the newest one is the last one.
+         */
+        uint8_t numberOfSamples;
+        arena::Handle samples;
+
+        void clear();
+
+        /**
+         * Renders all columns of the chart.
+         */
+        void loadIntoFramebuffer();
+
+        /**
+         * Stores the new sample. Sparkline columns don't depend on the other samples, so the chart is moved
+         * by one column and only the new column is rendered; the difference charts are rendered whole.
+         */
+        void append(int8_t sample);
+
+    private:
+        void renderColumn(uint8_t column, int8_t newest);
+    };
+
+    extern _Chart _charts[];
+
+    struct _NumberWidget {
+        uint8_t position;
+        uint8_t width; // 0 if the widget is disabled
+        uint8_t decimals;
+        uint8_t flags;
+        uint8_t unit; // character code, 0 if there is no unit
+
+        int32_t shownValue;
+        int32_t value;
+
+        void render() const;
+
+        /**
+         * Moves the shown value towards the value, by a fraction of the difference every frame, and renders it.
+         */
+        void count(uint8_t elapsedFrames);
+    };
+
+    extern _NumberWidget _numberWidgets[];
+
+    extern uint8_t _numberOfScrollingSlots;
+
+    /**
+     * Arena blocks with the columns of the user glyphs, INVALID_HANDLE if the glyph is not uploaded.
+     */
+    extern arena::Handle _userGlyphs[];
+
     namespace hd {
+        /**
+         * Refreshes the next grid. Called from the timer interrupt FRAME_RATE * NUM_OF_CHARACTERS times per second.
+         */
         void displayPool();
     }
 }
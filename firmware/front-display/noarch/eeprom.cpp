@@ -0,0 +1,81 @@
+#include "eeprom.hpp"
+
+using namespace octoglow::front_display::eeprom;
+
+struct QueuedWrite {
+    uint16_t address;
+    uint8_t value;
+};
+
+/*
+ * Written by the main loop at tail and read by the interrupt at head. Each index is changed only by one side
+ * and is a single byte, so no locking is needed. One entry is kept free to tell the full queue from the empty one.
+ */
+static QueuedWrite writeQueue[WRITE_QUEUE_LENGTH + 1];
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+
+static inline uint8_t nextIndex(const uint8_t index) {
+    return index == WRITE_QUEUE_LENGTH ? 0 : index + 1;
+}
+
+uint8_t octoglow::front_display::eeprom::readByte(const uint16_t address) {
+    // the newest queued value wins
+    bool queued = false;
+    uint8_t value = 0;
+    for (uint8_t i = queueHead; i != queueTail; i = nextIndex(i)) {
+        if (writeQueue[i].address == address) {
+            value = writeQueue[i].value;
+            queued = true;
+        }
+    }
+
+    // the write could have been started meanwhile, then the EEPROM already holds the value
+    return queued ? value : hd::read(address);
+}
+
+void octoglow::front_display::eeprom::updateByte(const uint16_t address, const uint8_t value) {
+    // reading the EEPROM would wait for the write in progress, the stored value is compared in onReady()
+    bool queued = false;
+    uint8_t queuedValue = 0;
+    for (uint8_t i = queueHead; i != queueTail; i = nextIndex(i)) {
+        if (writeQueue[i].address == address) {
+            queuedValue = writeQueue[i].value;
+            queued = true;
+        }
+    }
+
+    if (queued and queuedValue == value) {
+        return;
+    }
+
+    while (nextIndex(queueTail) == queueHead) {
+        hd::waitForWrite();
+    }
+
+    writeQueue[queueTail] = {address, value};
+    queueTail = nextIndex(queueTail);
+
+    hd::enableReadyInterrupt();
+}
+
+bool octoglow::front_display::eeprom::isIdle() {
+    return queueHead == queueTail;
+}
+
+void octoglow::front_display::eeprom::onReady() {
+    uint8_t head = queueHead;
+
+    while (head != queueTail and hd::readWhenReady(writeQueue[head].address) == writeQueue[head].value) {
+        head = nextIndex(head);
+    }
+    queueHead = head;
+
+    if (head == queueTail) {
+        hd::disableReadyInterrupt();
+        return;
+    }
+
+    hd::write(writeQueue[head].address, writeQueue[head].value);
+    queueHead = nextIndex(head);
+}
@@ -2,10 +2,82 @@
 
 #include "main.hpp"
 
+#include <inttypes.h>
+
 
 namespace octoglow::front_display::eeprom {
 
+    /**
+     * Area of the EEPROM holding the pages saved by pages::save().
+     */
+    constexpr uint16_t PAGE_STORE_ADDRESS = 32;
+    constexpr uint16_t PAGE_STORE_SIZE = 300;
+
+    /**
+     * Area of the settings store, two banks used alternately, see settings.hpp.
+     */
+    constexpr uint16_t SETTINGS_ADDRESS = PAGE_STORE_ADDRESS + PAGE_STORE_SIZE;
+    constexpr uint8_t SETTINGS_BANK_SIZE = 90;
+
+    constexpr uint16_t SIZE = 512;
+
+    static_assert(SETTINGS_ADDRESS + 2 * SETTINGS_BANK_SIZE <= SIZE, "EEPROM areas don't fit");
+
+    /**
+     * Number of byte writes which can wait for the EEPROM. Each write takes 3.4 ms.
+     */
+    constexpr uint8_t WRITE_QUEUE_LENGTH = 8;
+
     void saveEndYearOfConstruction(uint8_t year);
 
     uint8_t readEndYearOfConstruction();
+
+    /**
+     * Reads the byte, the writes still waiting in the queue included.
+     */
+    uint8_t readByte(uint16_t address);
+
+    /**
+     * Queues writing the byte, unless the same value is queued already. The EEPROM is not read, the bytes which
+     * hold the value already are dropped by onReady(). Returns at once, only if the queue is full it waits
+     * for the write in progress to finish.
+     */
+    void updateByte(uint16_t address, uint8_t value);
+
+    /**
+     * @return true if no write waits in the queue, the last one may be still in progress
+     */
+    bool isIdle();
+
+    /**
+     * Called from the EEPROM ready interrupt. Drops the queued bytes which the EEPROM holds already and starts
+     * the next write or, if there is none, disables the interrupt.
+     */
+    void onReady();
+
+    namespace hd {
+        /**
+         * Reads the byte from the EEPROM, waiting for the write in progress to finish first.
+         */
+        uint8_t read(uint16_t address);
+
+        /**
+         * Reads the byte without waiting. Called only from the ready interrupt, so the EEPROM is idle.
+         */
+        uint8_t readWhenReady(uint16_t address);
+
+        /**
+         * Starts the write. Called only from the ready interrupt, so the EEPROM is idle.
+         */
+        void write(uint16_t address, uint8_t value);
+
+        void enableReadyInterrupt();
+
+        void disableReadyInterrupt();
+
+        /**
+         * Waits until the write in progress finishes, resetting the watchdog.
+         */
+        void waitForWrite();
+    }
 }
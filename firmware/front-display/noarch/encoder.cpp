@@ -1,6 +1,65 @@
 #include "encoder.hpp"
+#include "display.hpp"
 
 namespace octoglow::front_display::encoder {
     ButtonState _currentButtonState = ButtonState::NO_CHANGE;
     volatile int8_t _currentEncoderSteps = 0;
+    volatile int16_t _position = 0;
+}
+
+using namespace octoglow::front_display::encoder;
+
+static Event events[EVENT_QUEUE_LENGTH];
+static uint8_t firstEvent = 0;
+static uint8_t numberOfEvents = 0;
+static uint8_t nextSequenceNumber = 0;
+static bool firstEventBeingRead = false;
+
+void octoglow::front_display::encoder::_pushEvent(const EventType type, const uint16_t timestamp) {
+    const uint8_t lastEventIdx = (firstEvent + numberOfEvents - 1) % EVENT_QUEUE_LENGTH;
+
+    if (numberOfEvents != 0
+        and (type == EventType::STEP_CW or type == EventType::STEP_CCW)
+        and events[lastEventIdx].type == type
+        and not (numberOfEvents == 1 and firstEventBeingRead)) {
+        events[lastEventIdx].position = _position;
+        events[lastEventIdx].timestamp = timestamp;
+        return;
+    }
+
+    const uint8_t sequenceNumber = nextSequenceNumber++;
+
+    if (numberOfEvents == EVENT_QUEUE_LENGTH) {
+        return;
+    }
+
+    events[(firstEvent + numberOfEvents) % EVENT_QUEUE_LENGTH] = {sequenceNumber, type, _position, timestamp};
+    ++numberOfEvents;
+
+    hd::setEventPending(true);
+}
+
+uint8_t octoglow::front_display::encoder::peekEvent(Event &event) {
+    if (numberOfEvents == 0) {
+        event = {nextSequenceNumber, EventType::NONE, _position, octoglow::front_display::display::_frameTicks};
+        return 0;
+    }
+
+    event = events[firstEvent];
+    firstEventBeingRead = true;
+    return numberOfEvents;
+}
+
+void octoglow::front_display::encoder::popEvent() {
+    if (not firstEventBeingRead) {
+        return;
+    }
+
+    firstEventBeingRead = false;
+    firstEvent = (firstEvent + 1) % EVENT_QUEUE_LENGTH;
+    --numberOfEvents;
+
+    if (numberOfEvents == 0) {
+        hd::setEventPending(false);
+    }
 }
@@ -10,6 +10,43 @@ namespace octoglow::front_display::encoder {
         JUST_RELEASED = -1
     };
 
+    enum class EventType : uint8_t {
+        NONE = 0,
+        STEP_CW,
+        STEP_CCW,
+        BUTTON_PRESSED,
+        BUTTON_RELEASED,
+        BUTTON_LONG_PRESSED,
+    };
+
+    /**
+     * Position is the absolute number of detents since power-on, the timestamp is display::_frameTicks.
+     * Consecutive steps in the same direction are merged into a single event as long as it isn't being read.
+     */
+    struct Event {
+        uint8_t sequenceNumber;
+        EventType type;
+        int16_t position;
+        uint16_t timestamp;
+    }__attribute__((packed));
+
+    static_assert(sizeof(Event) == 6, "invalid size");
+
+    constexpr uint8_t EVENT_QUEUE_LENGTH = 4;
+
+    constexpr uint16_t LONG_PRESS_TIME = 800; // ms
+
+    /**
+     * Interrupt load of the input sampling, accumulated since the last read.
+     */
+    struct InputLoad {
+        uint16_t frames; // display frames elapsed
+        uint16_t interrupts;
+        uint32_t cycles; // CPU cycles spent in the interrupt bodies
+    }__attribute__((packed));
+
+    static_assert(sizeof(InputLoad) == 8, "invalid size");
+
     void init();
 
     /*
@@ -19,6 +56,34 @@ namespace octoglow::front_display::encoder {
 
     ButtonState getButtonStateAndClear();
 
+    InputLoad getInputLoadAndClear();
+
+    /**
+     * Copies the oldest event without removing it. If the queue is empty, NONE event with the current position
+     * is returned. Marks the event as being read, so it is no longer merged with the new steps.
+     * @return number of pending events
+     */
+    uint8_t peekEvent(Event &event);
+
+    /**
+     * Removes the oldest event, if it was returned by peekEvent().
+     */
+    void popEvent();
+
+    /**
+     * Called from the interrupts. If the queue is full, the event is dropped, but its sequence number is used up,
+     * so the gap tells the reader about the loss.
+     */
+    void _pushEvent(EventType type, uint16_t timestamp);
+
     extern ButtonState _currentButtonState;
     extern volatile int8_t _currentEncoderSteps;
+    extern volatile int16_t _position;
+
+    namespace hd {
+        /**
+         * Drives the event pending output.
+         */
+        void setEventPending(bool pending);
+    }
 }
@@ -3,127 +3,497 @@
 #include "display.hpp"
 #include "encoder.hpp"
 #include "eeprom.hpp"
+#include "pages.hpp"
+#include "settings.hpp"
+#include "arena.hpp"
+#include "framing.hpp"
+
+#include <string.h>
 
 using namespace octoglow::front_display::protocol;
 using namespace octoglow::front_display;
+using namespace octoglow;
 
-constexpr uint8_t BUFFER_SIZE = 200;
-
-static uint8_t buffer[BUFFER_SIZE];
+/*
+ * The frame is received in the free space of the arena, taken at its first byte. The arena doesn't grow
+ * while the frame is received: the handlers run only after it is complete and the other code which allocates
+ * pauses the receiving first. Before execution, the frame is moved to the top of the arena, so the handler
+ * can allocate below it.
+ */
+static uint8_t *frame;
+static uint8_t frameCapacity;
+static uint8_t frameLength;
 static uint8_t bytesProcessed;
 
-static_assert(sizeof(buffer) >= 5, "buffer has to have at least 5 bytes");
-static_assert(sizeof(buffer) >= sizeof(encoder::ButtonState) + 2, "buffer has to contain whole ButtonState structure");
-static_assert(sizeof(buffer) >= sizeof(EncoderState) + 2, "buffer has to contain whole EncoderState structure");
+/*
+ * CRC, command number and the longest response payload.
+ */
+static uint8_t response[2 + 8];
+
+/*
+ * CRC of the bytes received after the CRC byte, updated with every byte, so the frame is validated in constant time.
+ */
+static uint8_t receivedCrc;
+
+/*
+ * Descriptor of the command being received, looked up once the command number arrives.
+ */
+static framing::CommandDescriptor receivedCommand;
+
+/*
+ * Text of the TERMINATED commands is converted to character codes as it is received, there is no second pass
+ * and the length of the UTF-8 text is not limited by the receive space.
+ */
+static display::Utf8Decoder textDecoder;
+
+/*
+ * Set by the interrupt when a complete frame with valid CRC is received. The frame and the response are owned
+ * by the main loop until the command is executed and the response is sealed.
+ */
+static volatile bool frameWaitingForExecution = false;
+
+/*
+ * Set when a frame is written while the previous one still waits for execution or the receiving is paused,
+ * or when it doesn't fit the free space of the arena. The frame is dropped, so reads return BUSY_RESPONSE
+ * or NO_SPACE_RESPONSE until the master writes a frame again.
+ */
+static volatile bool frameRejected = false;
+static uint8_t notReadyResponse[2];
+
+/*
+ * Set while the main loop allocates outside the command handlers. The frame being received then is dropped,
+ * until the master starts a new one.
+ */
+static volatile bool receivingPaused = false;
+static volatile bool frameDropped = false;
+
+static bool eventRead = false;
+static uint8_t eventResponse[2 + sizeof(encoder::Event)];
+
+static_assert(sizeof(response) >= sizeof(encoder::ButtonState) + 2, "response has to contain whole ButtonState structure");
+static_assert(sizeof(response) >= sizeof(EncoderState) + 2, "response has to contain whole EncoderState structure");
+static_assert(sizeof(response) >= sizeof(encoder::InputLoad) + 2, "response has to contain whole InputLoad structure");
+static_assert(sizeof(response) >= sizeof(i2c::BusLoad) + 2, "response has to contain whole BusLoad structure");
 
 void i2c::onTransmit(uint8_t volatile *value) {
-    *value = buffer[bytesProcessed];
+    if (eventRead) {
+        *value = bytesProcessed < sizeof(eventResponse) ? eventResponse[bytesProcessed] : 0;
+        if (bytesProcessed == sizeof(eventResponse) - 1) {
+            encoder::popEvent();
+        }
+    } else if (frameRejected or frameWaitingForExecution) {
+        *value = bytesProcessed < sizeof(notReadyResponse) ? notReadyResponse[bytesProcessed] : 0;
+    } else {
+        *value = bytesProcessed < sizeof(response) ? response[bytesProcessed] : 0;
+    }
     ++bytesProcessed;
 }
 
 void i2c::onStart() {
     bytesProcessed = 0;
+    receivedCrc = 0;
+    textDecoder = {};
+    eventRead = false;
 }
 
-__attribute__((optimize("O3"), hot))
-static bool checkCrc8fails() {
-    uint8_t calculatedCrcValue = 0;
-    for (uint8_t i = 1; i < bytesProcessed; i++) {
-        calculatedCrcValue = i2c::crc8ccittUpdate(calculatedCrcValue, buffer[i]);
-    }
+void i2c::onEventReadStart() {
+    bytesProcessed = 0;
+    eventRead = true;
 
-    if (buffer[0] != calculatedCrcValue) {
-        buffer[0] = 0;
-        buffer[1] = static_cast<uint8_t>(Command::NONE);
+    eventResponse[1] = encoder::peekEvent(*reinterpret_cast<encoder::Event *>(&eventResponse[2]));
+    framing::sealResponse(eventResponse, sizeof(encoder::Event));
+}
+
+static inline bool checkCrc8fails() {
+    if (frame[0] != receivedCrc) {
+        response[0] = 0;
+        response[1] = static_cast<uint8_t>(Command::NONE);
         return true;
     }
     return false;
 }
 
-static inline void setCrcForSimpleCommand() {
-    buffer[0] = i2c::crc8ccittUpdate(0, buffer[1]);
+static void getEncoderState(const uint8_t *, uint8_t *const response) {
+    auto *const encoderState = reinterpret_cast<EncoderState *>(response);
+    encoderState->buttonValue = encoder::getButtonStateAndClear();
+    encoderState->encoderValue = encoder::getValueAndClear();
 }
 
-static void setCrcForComplexCommand(const uint8_t payloadLength) {
-    uint8_t crcValue = 0;
-    for (uint8_t i = 1; i < payloadLength + 2; ++i) {
-        crcValue = i2c::crc8ccittUpdate(crcValue, buffer[i]);
-    }
-    buffer[0] = crcValue;
+static void clearDisplay(const uint8_t *, uint8_t *) {
+    display::clear();
 }
 
-__attribute__((optimize("O3"), hot))
-void i2c::onReceive(const uint8_t value) {
-    if (bytesProcessed == sizeof(buffer)) {
-        return;
+static void setBrightness(const uint8_t *const frame, uint8_t *) {
+    display::setBrightness(frame[1]);
+}
+
+static void writeStaticText(const uint8_t *const frame, uint8_t *) {
+    display::writeStaticCharacters(frame[1], frame[2], &frame[3]);
+}
+
+static void writeScrollingText(const uint8_t *const frame, uint8_t *) {
+    const uint8_t slotNumber = frame[1] & ~scroll::SPEED_FIELD_FLAG;
+    const bool hasSpeedField = frame[1] & scroll::SPEED_FIELD_FLAG;
+
+    display::writeScrollingCharacters(slotNumber, frame[2], frame[3], &frame[hasSpeedField ? 5 : 4]);
+    if (hasSpeedField) {
+        display::setScrollingSpeed(slotNumber, frame[4]);
     }
+}
 
-    buffer[bytesProcessed] = value;
-    ++bytesProcessed;
+static void drawGraphics(const uint8_t *const frame, uint8_t *) {
+    display::drawGraphics(frame[1], frame[2], frame[3], &frame[4]);
+}
 
-    // crc is at buffer 0, command is at 1
-    const auto cmd = static_cast<Command>(buffer[1]);
-
-    if (bytesProcessed == 2) {
-        if (cmd == Command::CLEAR_DISPLAY) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            display::clear();
-            setCrcForSimpleCommand();
-        } else if (cmd == Command::GET_ENCODER_STATE) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            auto *btnState = reinterpret_cast<EncoderState *>(buffer + 2);
-            btnState->buttonValue = encoder::getButtonStateAndClear();
-            btnState->encoderValue = encoder::getValueAndClear();
-
-            setCrcForComplexCommand(sizeof(EncoderState));
-        } else if (cmd == Command::READ_END_YEAR_OF_CONSTRUCTION) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            buffer[2] = eeprom::readEndYearOfConstruction();
-            setCrcForComplexCommand(1);
-        }
-    } else if (bytesProcessed == 3) {
-        if (cmd == Command::SET_BRIGHTNESS) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            display::setBrightness(buffer[2]);
-            setCrcForSimpleCommand();
-        } else if (cmd == Command::WRITE_END_YEAR_OF_CONSTRUCTION) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            eeprom::saveEndYearOfConstruction(buffer[2]);
-            setCrcForSimpleCommand();
+static void setUpperBar(const uint8_t *const frame, uint8_t *) {
+    display::setUpperBarContent(*reinterpret_cast<const uint32_t *>(frame + 1));
+}
+
+static void readEndYearOfConstruction(const uint8_t *, uint8_t *const response) {
+    response[0] = eeprom::readEndYearOfConstruction();
+}
+
+static void writeEndYearOfConstruction(const uint8_t *const frame, uint8_t *) {
+    eeprom::saveEndYearOfConstruction(frame[1]);
+}
+
+static void configureScrollingSlots(const uint8_t *const frame, uint8_t *) {
+    display::configureScrollingSlots(frame[1], &frame[2]);
+}
+
+static void uploadGlyph(const uint8_t *const frame, uint8_t *) {
+    display::uploadGlyph(frame[1], frame[2], &frame[3]);
+}
+
+static void drawGlyph(const uint8_t *const frame, uint8_t *) {
+    display::drawGlyph(frame[1], frame[2], frame[3]);
+}
+
+static void patchFrame(const uint8_t *const frame, uint8_t *) {
+    display::patchFrame(&frame[2], frame[1]);
+}
+
+static void executeBatch(const uint8_t *frame, uint8_t *);
+
+static void getInputLoad(const uint8_t *, uint8_t *const response) {
+    *reinterpret_cast<encoder::InputLoad *>(response) = encoder::getInputLoadAndClear();
+}
+
+static void getBusLoad(const uint8_t *, uint8_t *const response) {
+    *reinterpret_cast<i2c::BusLoad *>(response) = i2c::getBusLoadAndClear();
+}
+
+static void configureChart(const uint8_t *const frame, uint8_t *) {
+    display::configureChart(frame[1], frame[2], frame[3], frame[4], frame[5]);
+}
+
+static void setChartSamples(const uint8_t *const frame, uint8_t *) {
+    display::setChartSamples(frame[1], frame[2], reinterpret_cast<const int8_t *>(&frame[3]));
+}
+
+static void appendChartSample(const uint8_t *const frame, uint8_t *) {
+    display::appendChartSample(frame[1], static_cast<int8_t>(frame[2]));
+}
+
+static void startTicker(const uint8_t *const frame, uint8_t *) {
+    display::startTicker(frame[1], frame[2], frame[3], frame[4]);
+}
+
+static void appendTickerText(const uint8_t *const frame, uint8_t *) {
+    display::appendTickerCharacters(frame[1], &frame[2]);
+}
+
+static void getTickerFreeSpace(const uint8_t *const frame, uint8_t *const response) {
+    const uint8_t slotNumber = frame[1];
+    response[0] = display::tickerFreeSpace(slotNumber);
+}
+
+static void savePage(const uint8_t *const frame, uint8_t *const response) {
+    const uint8_t pageId = frame[1];
+    response[0] = pages::save(pageId);
+}
+
+static void showPage(const uint8_t *const frame, uint8_t *) {
+    pages::show(frame[1]);
+}
+
+static void setPageRotation(const uint8_t *const frame, uint8_t *) {
+    pages::setRotation(frame[1] / 2, &frame[2]);
+}
+
+static void saveSettings(const uint8_t *, uint8_t *) {
+    settings::saveDisplayState();
+}
+
+static void setSplashText(const uint8_t *const frame, uint8_t *) {
+    settings::saveSplashText(&frame[1]);
+}
+
+static void writeTextLayer(const uint8_t *const frame, uint8_t *) {
+    display::writeTextLayer(frame[1], frame[2], &frame[3]);
+}
+
+static void setTextLayerBlending(const uint8_t *const frame, uint8_t *) {
+    display::setTextLayerBlending(frame[1]);
+}
+
+static void showOverlay(const uint8_t *const frame, uint8_t *) {
+    display::showOverlay(frame[1], frame[4], frame[2], frame[3], &frame[5]);
+}
+
+static void setCellAttributes(const uint8_t *const frame, uint8_t *) {
+    display::setCellAttributes(frame[1], frame[2], frame[3]);
+}
+
+static void stageFrame(const uint8_t *, uint8_t *) {
+    display::stageFrame();
+}
+
+static void startTransition(const uint8_t *const frame, uint8_t *) {
+    display::startTransition(frame[1], frame[2]);
+}
+
+static void configureNumberWidget(const uint8_t *const frame, uint8_t *) {
+    display::configureNumberWidget(frame[1], frame[2], frame[3], frame[4], frame[5],
+                                   *reinterpret_cast<const uint16_t *>(frame + 6));
+}
+
+static void setWidgetValue16(const uint8_t *const frame, uint8_t *) {
+    display::setWidgetValue(frame[1], *reinterpret_cast<const int16_t *>(frame + 2));
+}
+
+static void setWidgetValue32(const uint8_t *const frame, uint8_t *) {
+    display::setWidgetValue(frame[1], *reinterpret_cast<const int32_t *>(frame + 2));
+}
+
+/**
+ * Frame of WRITE_SCROLLING_TEXT has the optional speed field before the text. The handlers of the TERMINATED
+ * commands get the text converted to character codes.
+ * Commands with response length 0 respond only with the command number.
+ */
+static constexpr framing::CommandDescriptor COMMANDS[] FRAMING_TABLE = {
+        framing::fixed(Command::GET_ENCODER_STATE, 1, getEncoderState, sizeof(EncoderState)),
+        framing::fixed(Command::CLEAR_DISPLAY, 1, clearDisplay),
+        framing::fixed(Command::SET_BRIGHTNESS, 2, setBrightness),
+        framing::terminated(Command::WRITE_STATIC_TEXT, 4, writeStaticText),
+        framing::terminated(Command::WRITE_SCROLLING_TEXT, 5, writeScrollingText, 1, scroll::SPEED_FIELD_FLAG),
+        framing::counted(Command::DRAW_GRAPHICS, 2, 4, drawGraphics),
+        framing::fixed(Command::SET_UPPER_BAR, 4, setUpperBar),
+        framing::fixed(Command::READ_END_YEAR_OF_CONSTRUCTION, 1, readEndYearOfConstruction, 1),
+        framing::fixed(Command::WRITE_END_YEAR_OF_CONSTRUCTION, 2, writeEndYearOfConstruction),
+        framing::counted(Command::CONFIGURE_SCROLLING_SLOTS, 1, 2, configureScrollingSlots),
+        framing::counted(Command::UPLOAD_GLYPH, 2, 3, uploadGlyph),
+        framing::fixed(Command::DRAW_GLYPH, 4, drawGlyph),
+        framing::counted(Command::PATCH_FRAME, 1, 2, patchFrame),
+        framing::counted(Command::BATCH, 1, 2, executeBatch),
+        framing::fixed(Command::GET_INPUT_LOAD, 1, getInputLoad, sizeof(encoder::InputLoad)),
+        framing::fixed(Command::GET_I2C_LOAD, 1, getBusLoad, sizeof(i2c::BusLoad)),
+        framing::fixed(Command::CONFIGURE_CHART, 6, configureChart),
+        framing::counted(Command::SET_CHART_SAMPLES, 2, 3, setChartSamples),
+        framing::fixed(Command::APPEND_CHART_SAMPLE, 3, appendChartSample),
+        framing::fixed(Command::START_TICKER, 5, startTicker),
+        framing::terminated(Command::APPEND_TICKER_TEXT, 3, appendTickerText),
+        framing::fixed(Command::GET_TICKER_FREE_SPACE, 2, getTickerFreeSpace, 1),
+        framing::fixed(Command::SAVE_PAGE, 2, savePage, 1),
+        framing::fixed(Command::SHOW_PAGE, 2, showPage),
+        framing::counted(Command::SET_PAGE_ROTATION, 1, 2, setPageRotation),
+        framing::fixed(Command::SAVE_SETTINGS, 1, saveSettings),
+        framing::terminated(Command::SET_SPLASH_TEXT, 2, setSplashText),
+        framing::terminated(Command::WRITE_TEXT_LAYER, 4, writeTextLayer),
+        framing::fixed(Command::SET_TEXT_LAYER_BLENDING, 2, setTextLayerBlending),
+        framing::counted(Command::SHOW_OVERLAY, 4, 5, showOverlay),
+        framing::fixed(Command::SET_CELL_ATTRIBUTES, 4, setCellAttributes),
+        framing::fixed(Command::STAGE_FRAME, 1, stageFrame),
+        framing::fixed(Command::START_TRANSITION, 3, startTransition),
+        framing::fixed(Command::CONFIGURE_NUMBER_WIDGET, 8, configureNumberWidget),
+        framing::fixed(Command::SET_WIDGET_VALUE_16, 4, setWidgetValue16),
+        framing::fixed(Command::SET_WIDGET_VALUE_32, 6, setWidgetValue32),
+};
+
+static_assert(framing::isValidTable(COMMANDS), "commands have to be listed in the order of their numbers");
+
+/**
+ * Every response fits its buffer and the frames of fixed length, with the CRC, fit the space the arena keeps free.
+ */
+static constexpr bool fitsReservedSpace() {
+    for (const framing::CommandDescriptor &descriptor : COMMANDS) {
+        if (descriptor.responseLength > sizeof(response) - 2
+            or (descriptor.framing == framing::Framing::FIXED and descriptor.length + 1 > arena::RECEIVE_RESERVE)) {
+            return false;
         }
-    } else if (cmd == Command::WRITE_STATIC_TEXT && value == 0 && bytesProcessed >= 4) {
-        if (checkCrc8fails()) {
+    }
+    return true;
+}
+
+static_assert(fitsReservedSpace(), "arena::RECEIVE_RESERVE or response is too small");
+
+/**
+ * Commands which only change the display state and don't respond with data. Only these can be batched.
+ */
+static inline bool isWriteCommand(const framing::CommandDescriptor &descriptor) {
+    return descriptor.responseLength == 0 and descriptor.command != static_cast<uint8_t>(Command::BATCH);
+}
+
+/**
+ * Executes the batched write commands one after another. Nothing is executed unless the whole batch consists
+ * of complete write commands. The refresh interrupt may show the state between them for a frame, STAGE_FRAME
+ * and START_TRANSITION around the batch avoid it.
+ */
+static void executeBatch(const uint8_t *const frame, uint8_t *) {
+    const uint8_t *const batch = &frame[2];
+    const uint8_t batchLength = frame[1];
+    framing::CommandDescriptor descriptor{};
+    uint8_t length;
+
+    for (uint8_t idx = 0; idx != batchLength; idx += length) {
+        if (not framing::findCommand(COMMANDS, batch[idx], descriptor) or not isWriteCommand(descriptor)) {
             return;
         }
-        display::writeStaticText(buffer[2], buffer[3], reinterpret_cast<char *>(&buffer[4]));
-        setCrcForSimpleCommand();
-    } else if (cmd == Command::WRITE_SCROLLING_TEXT && value == 0 && bytesProcessed >= 5) {
-        if (checkCrc8fails()) {
+        length = framing::frameLength(descriptor, batch + idx, batchLength - idx);
+        if (length == 0) {
             return;
         }
-        display::writeScrollingText(buffer[2], buffer[3], buffer[4], reinterpret_cast<char *>(&buffer[5]));
-        setCrcForSimpleCommand();
-    } else if (cmd == Command::DRAW_GRAPHICS && bytesProcessed >= 6 && (bytesProcessed - 5) == buffer[3]) {
-        if (checkCrc8fails()) {
-            return;
+    }
+
+    for (uint8_t idx = 0; idx != batchLength; idx += length) {
+        // the batch lies in the received frame, which is writable
+        auto *const command = const_cast<uint8_t *>(batch + idx);
+        framing::findCommand(COMMANDS, command[0], descriptor);
+        length = framing::frameLength(descriptor, command, batchLength - idx);
+
+        if (descriptor.framing == framing::Framing::TERMINATED) {
+            // only the text of a separate frame is converted while it is received
+            display::convertUtf8InPlace(command + framing::terminatedDataStart(descriptor, command));
+        }
+
+        descriptor.handler(command, nullptr);
+    }
+}
+
+/**
+ * Stores the byte of the text, converted to character codes. The last byte of the receive space is kept
+ * for the terminating zero.
+ * @return false if the text doesn't fit the receive space
+ */
+static inline bool storeTextByte(const uint8_t value) {
+    uint8_t codes[2];
+    const uint8_t count = textDecoder.decode(value, codes);
+
+    for (uint8_t i = 0; i != count; ++i) {
+        if (codes[i] != 0 and bytesProcessed >= frameCapacity - 1) {
+            return false;
         }
-        display::drawGraphics(buffer[2], buffer[3], buffer[4], &buffer[5]);
-        setCrcForSimpleCommand();
-    } else if (cmd == Command::SET_UPPER_BAR && bytesProcessed == 5) {
-        if (checkCrc8fails()) {
+        frame[bytesProcessed] = codes[i];
+        ++bytesProcessed;
+    }
+    return true;
+}
+
+static void setNotReadyResponse(const uint8_t response) {
+    notReadyResponse[1] = response;
+    framing::sealResponse(notReadyResponse, 0);
+}
+
+/**
+ * Drops the rest of the frame which doesn't fit the free space of the arena, reads return NO_SPACE_RESPONSE
+ * until the master writes a frame again.
+ */
+static void rejectOversizeFrame() {
+    frameDropped = true;
+    frameRejected = true;
+    setNotReadyResponse(NO_SPACE_RESPONSE);
+}
+
+void i2c::onReceive(const uint8_t value) {
+    if (bytesProcessed == 0) {
+        frameDropped = frameWaitingForExecution or receivingPaused;
+        if (not frameDropped) {
+            frameRejected = false;
+            frame = arena::freeSpace();
+            frameCapacity = arena::freeSpaceSize();
+        }
+    } else if (frameWaitingForExecution or receivingPaused) {
+        frameDropped = true;
+    }
+
+    if (frameDropped) {
+        if (not frameRejected) {
+            frameRejected = true;
+            setNotReadyResponse(BUSY_RESPONSE);
+        }
+        bytesProcessed = 1; // so the rest of the frame is dropped too
+        return;
+    }
+
+    if (bytesProcessed != 0) {
+        receivedCrc = framing::crc8ccittUpdate(receivedCrc, value);
+    }
+
+    // crc is at frame 0, command is at 1
+    if (bytesProcessed > 1
+        and receivedCommand.framing == framing::Framing::TERMINATED
+        and bytesProcessed - 1 >= framing::terminatedDataStart(receivedCommand, &frame[1])) {
+        if (not storeTextByte(value)) {
+            rejectOversizeFrame();
             return;
         }
-        display::setUpperBarContent(*reinterpret_cast<uint32_t *>(buffer + 2));
-        setCrcForSimpleCommand();
+    } else if (bytesProcessed != frameCapacity) {
+        frame[bytesProcessed] = value;
+        ++bytesProcessed;
+
+        if (bytesProcessed == 2 and not framing::findCommand(COMMANDS, value, receivedCommand)) {
+            receivedCommand = {}; // frame of zero length never completes
+        }
+    } else {
+        rejectOversizeFrame();
+        return;
+    }
+
+    if (bytesProcessed < 2 or not framing::isFrameComplete(receivedCommand, &frame[1], bytesProcessed - 1)) {
+        return;
+    }
+
+    if (checkCrc8fails()) {
+        return;
+    }
+
+    frameLength = bytesProcessed;
+    setNotReadyResponse(PENDING_RESPONSE);
+    framing::handOverBuffer();
+    frameWaitingForExecution = true;
+}
+
+void i2c::processDataIfAvailable() {
+    if (!frameWaitingForExecution) {
+        return;
     }
+    framing::handOverBuffer();
+
+    uint8_t *const executedFrame = arena::keepTop(frameLength);
+    memmove(executedFrame, frame, frameLength);
+
+    response[1] = executedFrame[1];
+    receivedCommand.handler(&executedFrame[1], &response[2]);
+    framing::sealResponse(response, receivedCommand.responseLength);
+    arena::releaseTop();
+
+    framing::handOverBuffer();
+    frameWaitingForExecution = false;
+}
+
+bool i2c::pauseReceiving() {
+    receivingPaused = true;
+    frameDropped = true;
+    framing::handOverBuffer();
+
+    if (frameWaitingForExecution) {
+        receivingPaused = false;
+        return false;
+    }
+    return true;
+}
+
+void i2c::resumeReceiving() {
+    framing::handOverBuffer();
+    receivingPaused = false;
 }
@@ -8,13 +8,64 @@
 namespace octoglow::front_display::i2c {
     constexpr uint8_t SLAVE_ADDRESS = 0x14;
 
+    /**
+     * Plain read from this address returns the oldest encoder event, no command has to be written first.
+     * Both addresses are matched with the address mask, so they differ only in the lowest bit.
+     */
+    constexpr uint8_t EVENT_SLAVE_ADDRESS = SLAVE_ADDRESS | 1;
+
+    static_assert(EVENT_SLAVE_ADDRESS != SLAVE_ADDRESS, "slave address has to be even");
+
+    /**
+     * Load of the TWI interrupt, accumulated since the last read.
+     */
+    struct BusLoad {
+        uint16_t interrupts; // one per byte, plus the address and the stop condition of every transmission
+        uint16_t maxCycles; // CPU cycles of the longest interrupt body
+        uint32_t cycles; // CPU cycles spent in the interrupt bodies
+    }__attribute__((packed));
+
+    static_assert(sizeof(BusLoad) == 8, "invalid size");
+
+    /**
+     * Reported if the firmware is built without I2C_LOAD_ACCOUNTING. No measurement can give it, an interrupt body
+     * never takes 0xffff cycles.
+     */
+    constexpr BusLoad NOT_MEASURED_BUS_LOAD = {0xffff, 0xffff, 0xffffffff};
+
+    BusLoad getBusLoadAndClear();
+
     void onStart();
 
+    /**
+     * Called instead of onStart() when the event address is read. Following onTransmit() calls send
+     * the event response: CRC, number of pending events and encoder::Event. The event is removed from the queue
+     * once its last byte has been sent.
+     */
+    void onEventReadStart();
+
     void onTransmit(uint8_t volatile *value);
 
+    /**
+     * Called from the TWI interrupt. Only stores the byte and validates the frame once it is complete.
+     */
     void onReceive(uint8_t value);
 
-    void init();
+    /**
+     * Executes the received command, if any, and prepares the response. Has to be called from the main loop.
+     * Until then, reads return PENDING_RESPONSE in place of the command number. Frames written meanwhile
+     * are dropped and reads return BUSY_RESPONSE until the next frame is written.
+     */
+    void processDataIfAvailable();
+
+    /**
+     * Frames are received in the free space of the arena, so the code which allocates outside the command
+     * handlers has to pause the receiving first. Frames written meanwhile are dropped, the master reads BUSY_RESPONSE.
+     * @return false if a received frame waits for execution, the arena can't grow then
+     */
+    bool pauseReceiving();
 
-    uint8_t crc8ccittUpdate(uint8_t inCrc, uint8_t inData);
+    void resumeReceiving();
+
+    void init();
 }
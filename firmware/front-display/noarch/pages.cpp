@@ -0,0 +1,324 @@
+#include "pages.hpp"
+#include "display.hpp"
+#include "eeprom.hpp"
+#include "i2c-slave.hpp"
+#include "protocol.hpp"
+
+using namespace octoglow::front_display;
+using namespace octoglow::front_display::display;
+using namespace octoglow::front_display::protocol;
+
+/*
+ * Page layout: length of the page, upper bar (3 bytes, little endian), run-length encoded framebuffer,
+ * number of the scrolling slots and, for each one, its number, position, window length, speed, text length
+ * and the converted text. Length 0 or larger than PAGE_SIZE means the page is empty, which is also the state
+ * of the erased EEPROM.
+ */
+constexpr uint8_t NUM_OF_COLUMNS = NUM_OF_CHARACTERS * COLUMNS_IN_CHARACTER;
+
+/**
+ * Run-length encoding: the control byte with RUN_FLAG set is followed by a single byte repeated (control & ~RUN_FLAG) + 1
+ * times, otherwise it is followed by control + 1 literal bytes.
+ */
+constexpr uint8_t RUN_FLAG = 0x80;
+constexpr uint8_t MAX_CHUNK_LENGTH = 128;
+
+/**
+ * Shorter runs of equal bytes take less space as a part of the literal chunk.
+ */
+constexpr uint8_t MIN_RUN_LENGTH = 3;
+
+constexpr uint8_t UPPER_BAR_BYTES = 3;
+constexpr uint8_t SLOT_HEADER_LENGTH = 5;
+
+static_assert(eeprom::PAGE_STORE_SIZE % page::NUMBER_OF_PAGES == 0, "page store has to divide evenly");
+
+struct RotationEntry {
+    uint8_t pageId;
+    uint8_t duration; // seconds
+};
+
+static RotationEntry rotation[page::MAX_ROTATION_LENGTH];
+static uint8_t rotationLength = 0;
+static uint8_t rotationIndex = 0;
+static uint16_t framesToNextPage = 0;
+static uint8_t lastFrameTicks = 0;
+
+static inline uint16_t pageAddress(const uint8_t pageId) {
+    return eeprom::PAGE_STORE_ADDRESS + static_cast<uint16_t>(pageId) * pages::PAGE_SIZE;
+}
+
+/**
+ * Writes the page after its length byte or, in the dry run, only counts its bytes. The length includes the length byte.
+ */
+struct PageWriter {
+    uint16_t address;
+    uint16_t length;
+    bool dryRun;
+
+    void put(const uint8_t value) {
+        ++length;
+        if (not dryRun) {
+            eeprom::updateByte(address + length - 1, value);
+        }
+    }
+};
+
+static uint8_t runLengthAt(const uint8_t column) {
+    uint8_t length = 1;
+    while (column + length < NUM_OF_COLUMNS
+           and length < MAX_CHUNK_LENGTH
+           and _frameBuffer[column + length] == _frameBuffer[column]) {
+        ++length;
+    }
+    return length;
+}
+
+static void writeFramebuffer(PageWriter &writer) {
+    uint8_t column = 0;
+
+    while (column < NUM_OF_COLUMNS) {
+        const uint8_t runLength = runLengthAt(column);
+
+        if (runLength >= MIN_RUN_LENGTH) {
+            writer.put(RUN_FLAG | (runLength - 1));
+            writer.put(_frameBuffer[column]);
+            column += runLength;
+            continue;
+        }
+
+        uint8_t literalLength = 0;
+        while (column + literalLength < NUM_OF_COLUMNS
+               and literalLength < MAX_CHUNK_LENGTH
+               and runLengthAt(column + literalLength) < MIN_RUN_LENGTH) {
+            ++literalLength;
+        }
+
+        writer.put(literalLength - 1);
+        for (uint8_t c = 0; c != literalLength; ++c) {
+            writer.put(_frameBuffer[column + c]);
+        }
+        column += literalLength;
+    }
+}
+
+/**
+ * Only the slots scrolling a fixed text are saved, tickers are left to the framebuffer image.
+ */
+static inline bool isSlotSaved(const _ScrollingSlot &slot) {
+    return slot.textLength != 0 and slot.length != 0 and not slot.ticker;
+}
+
+static void writePage(PageWriter &writer) {
+    writer.put(_upperBarBuffer);
+    writer.put(_upperBarBuffer >> 8);
+    writer.put(_upperBarBuffer >> 16);
+
+    writeFramebuffer(writer);
+
+    uint8_t numberOfSlots = 0;
+    for (uint8_t i = 0; i != _numberOfScrollingSlots; ++i) {
+        numberOfSlots += isSlotSaved(_scrollingSlots[i]) ? 1 : 0;
+    }
+    writer.put(numberOfSlots);
+
+    for (uint8_t i = 0; i != _numberOfScrollingSlots; ++i) {
+        const _ScrollingSlot &slot = _scrollingSlots[i];
+        if (not isSlotSaved(slot)) {
+            continue;
+        }
+
+        writer.put(i);
+        writer.put(slot.startPosition);
+        writer.put(slot.length);
+        writer.put(slot.speed);
+        writer.put(slot.textLength);
+        for (uint8_t c = 0; c != slot.textLength; ++c) {
+            writer.put(arena::get(slot.convertedText)[c]);
+        }
+    }
+}
+
+uint8_t octoglow::front_display::pages::save(const uint8_t pageId) {
+    if (pageId >= page::NUMBER_OF_PAGES) {
+        return 0;
+    }
+
+    const uint16_t address = pageAddress(pageId);
+    PageWriter counter{address, 1, true};
+    writePage(counter);
+
+    if (counter.length > PAGE_SIZE) {
+        return 0;
+    }
+
+    // the page is marked empty until it is complete
+    eeprom::updateByte(address, 0);
+    PageWriter writer{address, 1, false};
+    writePage(writer);
+    eeprom::updateByte(address, writer.length);
+
+    return writer.length;
+}
+
+/**
+ * Reads the page sequentially, never past its length.
+ */
+struct PageReader {
+    uint16_t address;
+    uint8_t position;
+    uint8_t length;
+
+    bool atEnd() const {
+        return position >= length;
+    }
+
+    uint8_t get() {
+        return atEnd() ? 0 : eeprom::readByte(address + position++);
+    }
+};
+
+/**
+ * Decodes the framebuffer and, if apply is set, writes it into _frameBuffer.
+ * @return false if the encoded framebuffer is truncated or too long
+ */
+static bool readFramebuffer(PageReader &reader, const bool apply) {
+    uint8_t column = 0;
+
+    while (column < NUM_OF_COLUMNS) {
+        if (reader.atEnd()) {
+            return false;
+        }
+
+        const uint8_t control = reader.get();
+        const uint8_t chunkLength = (control & ~RUN_FLAG) + 1;
+
+        if (chunkLength > NUM_OF_COLUMNS - column) {
+            return false;
+        }
+
+        const uint8_t value = (control & RUN_FLAG) ? reader.get() : 0;
+        for (uint8_t c = 0; c != chunkLength; ++c) {
+            const uint8_t columnContent = (control & RUN_FLAG) ? value : reader.get();
+            if (apply) {
+                _frameBuffer[column + c] = columnContent;
+            }
+        }
+        column += chunkLength;
+    }
+
+    return true;
+}
+
+static void readScrollingSlots(PageReader &reader) {
+    for (uint8_t numberOfSlots = reader.get(); numberOfSlots != 0 and not reader.atEnd(); --numberOfSlots) {
+        uint8_t header[SLOT_HEADER_LENGTH];
+        for (auto &b : header) {
+            b = reader.get();
+        }
+
+        const uint8_t textLength = header[4];
+        arena::Handle text = arena::INVALID_HANDLE;
+
+        if (header[0] < _numberOfScrollingSlots and textLength != 0) {
+            text = arena::allocate(textLength);
+        }
+
+        for (uint8_t c = 0; c != textLength; ++c) {
+            const uint8_t code = reader.get();
+            if (text != arena::INVALID_HANDLE) {
+                arena::get(text)[c] = code;
+            }
+        }
+
+        if (text == arena::INVALID_HANDLE) {
+            continue;
+        }
+
+        _ScrollingSlot &slot = _scrollingSlots[header[0]];
+        slot.clear();
+        slot.convertedText = text;
+        slot.textLength = textLength;
+        slot.startPosition = header[1];
+        slot.length = header[2];
+        slot.speed = header[3];
+        slot.currentShift = 0;
+        slot.speedAccumulator = 0;
+        slot.loadIntoFramebuffer();
+    }
+}
+
+bool octoglow::front_display::pages::show(const uint8_t pageId) {
+    if (pageId >= page::NUMBER_OF_PAGES) {
+        return false;
+    }
+
+    const uint16_t address = pageAddress(pageId);
+    const uint8_t length = eeprom::readByte(address);
+
+    if (length == 0 or length > PAGE_SIZE) {
+        return false;
+    }
+
+    PageReader reader{address, 1, length};
+    PageReader validator{address, 1 + UPPER_BAR_BYTES, length};
+
+    if (not readFramebuffer(validator, false)) {
+        return false;
+    }
+
+    clear();
+
+    uint32_t upperBar = reader.get();
+    upperBar |= static_cast<uint32_t>(reader.get()) << 8;
+    upperBar |= static_cast<uint32_t>(reader.get()) << 16;
+    setUpperBarContent(upperBar);
+
+    readFramebuffer(reader, true);
+    readScrollingSlots(reader);
+
+    return true;
+}
+
+static void showRotationEntry(const uint8_t index) {
+    rotationIndex = index;
+    framesToNextPage = static_cast<uint16_t>(rotation[index].duration) * FRAME_RATE;
+    pages::show(rotation[index].pageId);
+}
+
+void octoglow::front_display::pages::setRotation(const uint8_t numberOfEntries, const uint8_t *const entries) {
+    rotationLength = numberOfEntries < page::MAX_ROTATION_LENGTH ? numberOfEntries : page::MAX_ROTATION_LENGTH;
+
+    for (uint8_t i = 0; i != rotationLength; ++i) {
+        rotation[i] = {entries[2 * i], entries[2 * i + 1]};
+    }
+
+    if (rotationLength != 0) {
+        lastFrameTicks = static_cast<uint8_t>(_frameTicks);
+        showRotationEntry(0);
+    }
+}
+
+void octoglow::front_display::pages::pool() {
+    if (rotationLength == 0) {
+        return;
+    }
+
+    // the low byte is read atomically and suffices for the difference
+    const uint8_t frameTicks = static_cast<uint8_t>(_frameTicks);
+    const uint8_t elapsedFrames = frameTicks - lastFrameTicks;
+    lastFrameTicks = frameTicks;
+
+    if (elapsedFrames < framesToNextPage) {
+        framesToNextPage -= elapsedFrames;
+        return;
+    }
+
+    // the slot texts are allocated from the arena, where the frames are received
+    if (not i2c::pauseReceiving()) {
+        framesToNextPage = 0;
+        return;
+    }
+    showRotationEntry(rotationIndex + 1 < rotationLength ? rotationIndex + 1 : 0);
+    i2c::resumeReceiving();
+}
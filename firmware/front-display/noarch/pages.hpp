@@ -0,0 +1,42 @@
+#pragma once
+
+#include "eeprom.hpp"
+#include "protocol.hpp"
+
+#include <inttypes.h>
+
+/*
+ * Snapshots of the display kept in the EEPROM, so a view prepared once can be shown again with a single command,
+ * also by the device itself following the rotation schedule. A page holds the upper bar, the framebuffer compressed
+ * with run-length encoding and the texts of the scrolling slots. Charts and tickers are saved as their current image.
+ */
+namespace octoglow::front_display::pages {
+
+    /**
+     * EEPROM space of a single page, including its length byte.
+     */
+    constexpr uint8_t PAGE_SIZE = eeprom::PAGE_STORE_SIZE / protocol::page::NUMBER_OF_PAGES;
+
+    /**
+     * Saves the current content of the display as the page. The previous page is left intact if the new one doesn't fit.
+     * @return number of bytes of the page or 0 if it doesn't fit PAGE_SIZE
+     */
+    uint8_t save(uint8_t pageId);
+
+    /**
+     * Replaces the content of the display with the page.
+     * @return false if the page is empty or corrupted, the display is left unchanged then
+     */
+    bool show(uint8_t pageId);
+
+    /**
+     * Starts showing the pages in turn, each for its duration. Zero entries stop the rotation.
+     * @param entries pairs of the page id and the duration in seconds
+     */
+    void setRotation(uint8_t numberOfEntries, const uint8_t *entries);
+
+    /**
+     * Switches the pages of the rotation. Has to be called from the main loop.
+     */
+    void pool();
+}
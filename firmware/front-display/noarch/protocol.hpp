@@ -11,14 +11,153 @@ namespace octoglow::front_display::protocol {
         GET_ENCODER_STATE = 1,
         CLEAR_DISPLAY,
         SET_BRIGHTNESS,
+        /**
+         * Texts are UTF-8, terminated by zero. They are converted to character codes while being received,
+         * so only the number of characters is limited by the free space of the arena. Longer texts are refused
+         * with NO_SPACE_RESPONSE.
+         */
         WRITE_STATIC_TEXT,
         WRITE_SCROLLING_TEXT,
         DRAW_GRAPHICS,
         SET_UPPER_BAR,
         READ_END_YEAR_OF_CONSTRUCTION,
         WRITE_END_YEAR_OF_CONSTRUCTION,
+        CONFIGURE_SCROLLING_SLOTS,
+        UPLOAD_GLYPH,
+        DRAW_GLYPH,
+        PATCH_FRAME,
+        /**
+         * Payload is its length followed by write commands, each one as the command number and its payload
+         * formatted the same way as in a separate frame, without the CRC. Commands responding with data
+         * can't be batched. The batch is executed as a whole and acknowledged once.
+         */
+        BATCH,
+        /**
+         * Responds with encoder::InputLoad, the counters are cleared.
+         */
+        GET_INPUT_LOAD,
+        /**
+         * Responds with i2c::BusLoad, the counters are cleared. The average number of cycles per interrupt
+         * tells how long SCL is stretched after every byte. If the firmware is built without I2C_LOAD_ACCOUNTING,
+         * all bytes of the response are 0xff, i2c::NOT_MEASURED_BUS_LOAD.
+         */
+        GET_I2C_LOAD,
+        /**
+         * Chart id, column position, width in columns, chart::Style and the scale. Clears the samples.
+         */
+        CONFIGURE_CHART,
+        /**
+         * Chart id, number of samples and the samples, the oldest first. Replaces all samples of the chart.
+         */
+        SET_CHART_SAMPLES,
+        /**
+         * Chart id and a single sample. Shifts the chart by one column, so a periodic update takes 3 bytes
+         * instead of the whole image.
+         */
+        APPEND_CHART_SAMPLE,
+        /**
+         * Slot number, position, window length and the speed in columns per second. Starts the ticker mode
+         * of the scrolling slot, with empty text.
+         */
+        START_TICKER,
+        /**
+         * Slot number and the UTF-8 text terminated by zero, appended to the ticker text. The text which doesn't fit
+         * the free space is dropped.
+         */
+        APPEND_TICKER_TEXT,
+        /**
+         * Slot number. Responds with the number of characters which can be appended to the ticker.
+         */
+        GET_TICKER_FREE_SPACE,
+        /**
+         * Page id. Saves the current content of the display in the page store, see pages::save().
+         * Responds with the number of bytes of the page, 0 if it doesn't fit.
+         */
+        SAVE_PAGE,
+        /**
+         * Page id. Replaces the content of the display with the saved page.
+         */
+        SHOW_PAGE,
+        /**
+         * Number of bytes followed by the pairs of the page id and the time to show it, in seconds. The device shows
+         * the pages in turn until the empty rotation is set.
+         */
+        SET_PAGE_ROTATION,
+        /**
+         * Stores the current brightness, scrolling slot configuration and user glyphs in the EEPROM,
+         * they are restored at power-on.
+         */
+        SAVE_SETTINGS,
+        /**
+         * UTF-8 text terminated by zero, shown at power-on instead of the demo. Empty text removes it.
+         */
+        SET_SPLASH_TEXT,
+        /**
+         * Position, maximal length and the UTF-8 text terminated by zero, written into the text layer.
+         * The cells up to the maximal length after the text become transparent.
+         */
+        WRITE_TEXT_LAYER,
+        /**
+         * layer::Blending of the text layer.
+         */
+        SET_TEXT_LAYER_BLENDING,
+        /**
+         * Column position, layer::Blending, time to show the overlay in units of layer::DURATION_UNIT frames,
+         * number of columns and the columns. Duration 0 keeps the overlay until it is replaced,
+         * no columns remove it.
+         */
+        SHOW_OVERLAY,
+        /**
+         * Position, number of characters and the attribute flags, which replace the attributes of the characters.
+         */
+        SET_CELL_ATTRIBUTES,
+        /**
+         * Keeps the displayed image while the following commands write the next one, at most for
+         * transition::STAGING_TIMEOUT frames. The kept image takes 200 bytes of the arena; if they aren't
+         * free, the following commands are shown at once.
+         */
+        STAGE_FRAME,
+        /**
+         * transition::Style and the duration in units of transition::DURATION_UNIT frames. Changes the displayed
+         * image into the staged one.
+         */
+        START_TRANSITION,
+        /**
+         * Widget id, position, width in characters, number of decimals, widget flags and the code point
+         * of the unit (2 bytes, little endian, 0 for none). Shows zero, zero width disables the widget.
+         * The widget is disabled also if the number of decimals exceeds widget::MAX_DECIMALS or leaves no
+         * character for the integer part.
+         */
+        CONFIGURE_NUMBER_WIDGET,
+        /**
+         * Widget id and the value as int16_t, little endian.
+         */
+        SET_WIDGET_VALUE_16,
+        /**
+         * Widget id and the value as int32_t, little endian.
+         */
+        SET_WIDGET_VALUE_32,
     };
 
+    /**
+     * Sent in the response instead of the command number while the received command waits for execution.
+     * The command was accepted, the master has to read the response again, without writing the command again.
+     */
+    constexpr uint8_t PENDING_RESPONSE = 0xfe;
+
+    /**
+     * Sent in the response instead of the command number if the command was written while the previous one
+     * still waited for execution. The command was not accepted, the master has to write it again.
+     */
+    constexpr uint8_t BUSY_RESPONSE = 0xff;
+
+    /**
+     * Sent in the response instead of the command number if the frame didn't fit the free space of the arena,
+     * which also holds the scrolling texts, user glyphs, charts and layers. The command was not accepted; writing
+     * it again helps only after the space is freed, e.g. by CLEAR_DISPLAY or a shorter text of the slot.
+     */
+    constexpr uint8_t NO_SPACE_RESPONSE = 0xfd;
+
     struct EncoderState {
         int8_t encoderValue;
         encoder::ButtonState buttonValue;
@@ -26,12 +165,23 @@ namespace octoglow::front_display::protocol {
 
     static_assert(sizeof(EncoderState) == 2, "invalid size");
 
+    namespace brightness {
+        /**
+         * If set in the SET_BRIGHTNESS argument, the remaining bits are the fine brightness level.
+         */
+        constexpr uint8_t FINE_LEVEL_FLAG = 0x80;
+    }
+
     namespace text {
         constexpr uint8_t MODE = 't';
     }
 
     namespace scroll {
+        /**
+         * Number of slots after power-on. CONFIGURE_SCROLLING_SLOTS can set up to MAX_NUMBER_OF_SLOTS.
+         */
         constexpr uint8_t NUMBER_OF_SLOTS = 3;
+        constexpr uint8_t MAX_NUMBER_OF_SLOTS = 5;
 
         constexpr uint8_t MODE = 's';
 
@@ -39,9 +189,138 @@ namespace octoglow::front_display::protocol {
         constexpr uint8_t SLOT1 = '1';
         constexpr uint8_t SLOT2 = '2';
 
+        /**
+         * Default maximal text lengths, in characters. The texts of all slots share the arena, which has to fit
+         * their actual lengths and the frame being received: a new text of the slot is received while the old one
+         * is still allocated, so it gets NO_SPACE_RESPONSE if both don't fit together.
+         */
         constexpr uint8_t SLOT0_MAX_LENGTH = 150;
         constexpr uint8_t SLOT1_MAX_LENGTH = 70;
         constexpr uint8_t SLOT2_MAX_LENGTH = 30;
+
+        /**
+         * If set in the slot number of WRITE_SCROLLING_TEXT, the window length is followed by
+         * the scrolling speed in columns per second.
+         */
+        constexpr uint8_t SPEED_FIELD_FLAG = 0x80;
+
+        constexpr uint8_t DEFAULT_SPEED = 30; // columns per second
+    }
+
+    namespace glyph {
+        /**
+         * Number of user glyphs which can be uploaded with UPLOAD_GLYPH. Their columns are kept
+         * in the arena, shared with the scrolling texts.
+         */
+        constexpr uint8_t MAX_NUMBER_OF_GLYPHS = 8;
+
+        /**
+         * User glyphs are written in texts as consecutive code points of the private use area, starting with this one.
+         * In texts only the first character width of a glyph is shown; DRAW_GLYPH draws it whole.
+         */
+        constexpr uint16_t FIRST_CODE_POINT = 0xe000;
+    }
+
+    /**
+     * Charts are drawn by the device from 8-bit signed samples, the newest sample in the rightmost column.
+     * The samples are kept in the arena, shared with the scrolling texts and the user glyphs.
+     */
+    namespace chart {
+        constexpr uint8_t MAX_NUMBER_OF_CHARTS = 2;
+
+        enum class Style : uint8_t {
+            /**
+             * Bar from the middle row showing the difference of the sample from the newest one divided by the scale,
+             * up to 3 rows up or down. The newest sample is drawn as the middle row marker.
+             */
+            DIFF_BARS,
+            /**
+             * Single dot at the row given by the sample divided by the scale, 0 is the bottom row.
+             */
+            SPARKLINE,
+            /**
+             * Same as DIFF_BARS with up to 7 rows in each direction: the higher samples are drawn in the upper
+             * line of the display, the lower ones in the lower line, the same column below. The chart has to be
+             * placed in the upper line.
+             */
+            TWO_LINES,
+        };
+
+        /**
+         * Sample without a value, drawn as a distinct marker. Columns before the first sample are blank.
+         */
+        constexpr int8_t NO_VALUE = -128;
+    }
+
+    namespace page {
+        constexpr uint8_t NUMBER_OF_PAGES = 3;
+        constexpr uint8_t MAX_ROTATION_LENGTH = 4;
+    }
+
+    /**
+     * The framebuffer written by all other commands is the bottom layer. The text layer and the overlay are kept
+     * apart from it and blended over it, in this order, when the wire image is built, so writing or removing them
+     * leaves the framebuffer intact.
+     */
+    namespace layer {
+        enum class Blending : uint8_t {
+            OR, // dots of the layer are added to the ones below
+            REPLACE, // columns covered by the layer replace the ones below
+            MASK, // dots of the layer clear the ones below
+        };
+
+        constexpr uint8_t DURATION_UNIT = 10; // frames
+    }
+
+    /**
+     * Character attributes are applied while the grids are refreshed, the content of the display is kept.
+     */
+    namespace attribute {
+        constexpr uint8_t BLINK_FLAG = 0x01; // blanked every other display::BLINK_HALF_PERIOD
+        constexpr uint8_t INVERSE_FLAG = 0x02;
+        constexpr uint8_t DIM_FLAG = 0x04; // half the brightness level
+    }
+
+    namespace transition {
+        enum class Style : uint8_t {
+            WIPE, // the new image replaces the old one column by column, from the left, in both lines at once
+            SLIDE, // in every character the old content moves out to the left, the new one comes in from the right
+            DISSOLVE, // dots change in the pseudo-random order
+            UPPER_BAR_SWEEP, // WIPE with the upper bar segment over the edge lit
+        };
+
+        constexpr uint8_t DURATION_UNIT = 10; // frames
+
+        /**
+         * Frames after STAGE_FRAME, after which the staged image is shown at once if START_TRANSITION
+         * hasn't come, so the display isn't frozen when the master stops in the middle.
+         */
+        constexpr uint8_t STAGING_TIMEOUT = 200;
+    }
+
+    /**
+     * Number widgets show an integer value divided by 10 to the number of decimals, right-aligned in their
+     * characters, followed by the unit. A value which doesn't fit is shown as '#' characters.
+     */
+    namespace widget {
+        constexpr uint8_t MAX_NUMBER_OF_WIDGETS = 3;
+        constexpr uint8_t MAX_WIDTH = 16;
+        constexpr uint8_t MAX_DECIMALS = 9; // int32_t has 10 digits
+
+        constexpr uint8_t PLUS_SIGN_FLAG = 0x01; // positive values are shown with '+'
+        constexpr uint8_t LEADING_ZEROS_FLAG = 0x02; // the whole width is filled with digits
+        constexpr uint8_t COUNTING_FLAG = 0x04; // shown value counts towards the new one instead of jumping
+    }
+
+    /**
+     * PATCH_FRAME payload is a list of segments: column offset from the end of the previous segment
+     * (from column 0 for the first one), header byte and data. The header holds the flags and the run length
+     * minus one. A repeated run has a single data byte, otherwise there is one byte per column.
+     */
+    namespace patch {
+        constexpr uint8_t XOR_FLAG = 0x80; // data is XORed with the current columns instead of replacing them
+        constexpr uint8_t REPEAT_FLAG = 0x40; // single data byte fills the whole run
+        constexpr uint8_t RUN_LENGTH_MASK = 0x3f;
     }
 
     namespace pixel {
@@ -0,0 +1,265 @@
+#include "settings.hpp"
+#include "display.hpp"
+#include "eeprom.hpp"
+#include "arena.hpp"
+
+using namespace octoglow::front_display;
+using namespace octoglow::front_display::settings;
+
+constexpr uint8_t ERASED = 0xff;
+
+/**
+ * Generation numbers count up to 0xfe, 0xff marks the erased bank.
+ */
+constexpr uint8_t MAX_GENERATION = 0xfe;
+
+constexpr uint8_t RECORD_HEADER_LENGTH = 2;
+constexpr uint8_t FIRST_RECORD_OFFSET = 1;
+
+static_assert(NUMBER_OF_KEYS < ERASED, "key would be taken for the end of the log");
+
+static uint8_t activeBank = 0;
+
+/**
+ * Offset of the first free byte of the active bank.
+ */
+static uint8_t logEnd = FIRST_RECORD_OFFSET;
+
+static inline uint16_t bankAddress(const uint8_t bank) {
+    return eeprom::SETTINGS_ADDRESS + static_cast<uint16_t>(bank) * eeprom::SETTINGS_BANK_SIZE;
+}
+
+static inline uint8_t nextGeneration(const uint8_t generation) {
+    return generation == MAX_GENERATION ? 0 : generation + 1;
+}
+
+/**
+ * Walks through the records of the bank.
+ * @return offset of the end of the log
+ */
+template<typename F>
+static uint8_t forEachRecord(const uint8_t bank, F &&callback) {
+    const uint16_t address = bankAddress(bank);
+    uint8_t offset = FIRST_RECORD_OFFSET;
+
+    while (offset + RECORD_HEADER_LENGTH <= eeprom::SETTINGS_BANK_SIZE) {
+        const uint8_t key = eeprom::readByte(address + offset);
+        const uint8_t length = eeprom::readByte(address + offset + 1);
+
+        if (key == ERASED or length > eeprom::SETTINGS_BANK_SIZE - offset - RECORD_HEADER_LENGTH) {
+            break;
+        }
+
+        callback(key, address + offset + RECORD_HEADER_LENGTH, length);
+        offset += RECORD_HEADER_LENGTH + length;
+    }
+
+    return offset;
+}
+
+static uint16_t findInBank(const uint8_t bank, const uint8_t key, uint8_t &length) {
+    uint16_t found = 0;
+    forEachRecord(bank, [&](const uint8_t recordKey, const uint16_t dataAddress, const uint8_t recordLength) {
+        if (recordKey == key) {
+            found = dataAddress;
+            length = recordLength;
+        }
+    });
+    return found;
+}
+
+/**
+ * Writes the record at the offset of the bank, followed by the end of the log. The key is written last.
+ */
+static void writeRecord(const uint8_t bank,
+                        const uint8_t offset,
+                        const uint8_t key,
+                        const uint8_t length,
+                        const uint8_t *const data,
+                        const uint16_t eepromData) {
+    const uint16_t address = bankAddress(bank) + offset;
+    const uint8_t end = offset + RECORD_HEADER_LENGTH + length;
+
+    if (end < eeprom::SETTINGS_BANK_SIZE) {
+        eeprom::updateByte(bankAddress(bank) + end, ERASED);
+    }
+
+    eeprom::updateByte(address + 1, length);
+    for (uint8_t i = 0; i != length; ++i) {
+        eeprom::updateByte(address + RECORD_HEADER_LENGTH + i,
+                           data != nullptr ? data[i] : eeprom::readByte(eepromData + i));
+    }
+    eeprom::updateByte(address, key);
+}
+
+/**
+ * Copies the valid records and the new one to the other bank and makes it active.
+ */
+static bool compact(const uint8_t key, const uint8_t *const data, const uint8_t length) {
+    uint16_t requiredSpace = FIRST_RECORD_OFFSET + (length != 0 ? RECORD_HEADER_LENGTH + length : 0);
+    for (uint8_t k = 0; k != NUMBER_OF_KEYS; ++k) {
+        uint8_t recordLength;
+        if (k != key and findInBank(activeBank, k, recordLength) != 0 and recordLength != 0) {
+            requiredSpace += RECORD_HEADER_LENGTH + recordLength;
+        }
+    }
+
+    if (requiredSpace > eeprom::SETTINGS_BANK_SIZE) {
+        return false;
+    }
+
+    const uint8_t newBank = activeBank ^ 1;
+    uint8_t offset = FIRST_RECORD_OFFSET;
+
+    for (uint8_t k = 0; k != NUMBER_OF_KEYS; ++k) {
+        uint8_t recordLength;
+        const uint16_t recordData = findInBank(activeBank, k, recordLength);
+        if (k != key and recordData != 0 and recordLength != 0) {
+            writeRecord(newBank, offset, k, recordLength, nullptr, recordData);
+            offset += RECORD_HEADER_LENGTH + recordLength;
+        }
+    }
+
+    if (length != 0) {
+        writeRecord(newBank, offset, key, length, data, 0);
+        offset += RECORD_HEADER_LENGTH + length;
+    } else if (offset < eeprom::SETTINGS_BANK_SIZE) {
+        eeprom::updateByte(bankAddress(newBank) + offset, ERASED);
+    }
+
+    eeprom::updateByte(bankAddress(newBank), nextGeneration(eeprom::readByte(bankAddress(activeBank))));
+
+    activeBank = newBank;
+    logEnd = offset;
+    return true;
+}
+
+void octoglow::front_display::settings::init() {
+    const uint8_t generation0 = eeprom::readByte(bankAddress(0));
+    const uint8_t generation1 = eeprom::readByte(bankAddress(1));
+
+    if (generation0 == ERASED and generation1 == ERASED) {
+        activeBank = 0;
+        eeprom::updateByte(bankAddress(0) + FIRST_RECORD_OFFSET, ERASED);
+        eeprom::updateByte(bankAddress(0), 0);
+    } else if (generation1 == ERASED) {
+        activeBank = 0;
+    } else if (generation0 == ERASED) {
+        activeBank = 1;
+    } else {
+        activeBank = generation1 == nextGeneration(generation0) ? 1 : 0;
+    }
+
+    logEnd = forEachRecord(activeBank, [](uint8_t, uint16_t, uint8_t) {});
+}
+
+uint16_t octoglow::front_display::settings::find(const Key key, uint8_t &length) {
+    return findInBank(activeBank, static_cast<uint8_t>(key), length);
+}
+
+bool octoglow::front_display::settings::put(const Key key, const uint8_t *const data, const uint8_t length) {
+    uint8_t storedLength = 0;
+    const uint16_t stored = find(key, storedLength);
+
+    if (stored == 0 ? length == 0 : storedLength == length) {
+        bool same = true;
+        for (uint8_t i = 0; i != length and same; ++i) {
+            same = eeprom::readByte(stored + i) == data[i];
+        }
+        if (same) {
+            return true;
+        }
+    }
+
+    if (logEnd + RECORD_HEADER_LENGTH + length > eeprom::SETTINGS_BANK_SIZE) {
+        return compact(static_cast<uint8_t>(key), data, length);
+    }
+
+    writeRecord(activeBank, logEnd, static_cast<uint8_t>(key), length, data, 0);
+    logEnd += RECORD_HEADER_LENGTH + length;
+    return true;
+}
+
+void octoglow::front_display::settings::saveDisplayState() {
+    const uint8_t brightness = protocol::brightness::FINE_LEVEL_FLAG | display::_brightness;
+    put(Key::BRIGHTNESS, &brightness, 1);
+
+    uint8_t slots[1 + protocol::scroll::MAX_NUMBER_OF_SLOTS];
+    slots[0] = display::_numberOfScrollingSlots;
+    for (uint8_t i = 0; i != display::_numberOfScrollingSlots; ++i) {
+        slots[1 + i] = display::_scrollingSlots[i].maxTextLength;
+    }
+    put(Key::SCROLLING_SLOTS, slots, 1 + display::_numberOfScrollingSlots);
+
+    for (uint8_t i = 0; i != protocol::glyph::MAX_NUMBER_OF_GLYPHS; ++i) {
+        const arena::Handle glyph = display::_userGlyphs[i];
+        put(static_cast<Key>(static_cast<uint8_t>(Key::FIRST_GLYPH) + i),
+            glyph != arena::INVALID_HANDLE ? arena::get(glyph) : nullptr,
+            arena::size(glyph));
+    }
+}
+
+void octoglow::front_display::settings::restoreDisplayState() {
+    uint8_t length;
+    uint16_t stored;
+
+    if ((stored = find(Key::BRIGHTNESS, length)) != 0 and length == 1) {
+        display::setBrightness(eeprom::readByte(stored));
+    }
+
+    if ((stored = find(Key::SCROLLING_SLOTS, length)) != 0 and length > 1) {
+        uint8_t capacities[protocol::scroll::MAX_NUMBER_OF_SLOTS];
+        const uint8_t numberOfSlots = length - 1 < protocol::scroll::MAX_NUMBER_OF_SLOTS
+                                      ? length - 1
+                                      : protocol::scroll::MAX_NUMBER_OF_SLOTS;
+        for (uint8_t i = 0; i != numberOfSlots; ++i) {
+            capacities[i] = eeprom::readByte(stored + 1 + i);
+        }
+        display::configureScrollingSlots(numberOfSlots, capacities);
+    }
+
+    for (uint8_t i = 0; i != protocol::glyph::MAX_NUMBER_OF_GLYPHS; ++i) {
+        stored = find(static_cast<Key>(static_cast<uint8_t>(Key::FIRST_GLYPH) + i), length);
+        if (stored == 0 or length == 0) {
+            continue;
+        }
+
+        // read straight into the arena, the glyph can be wider than any buffer on the stack
+        arena::Handle &glyph = display::_userGlyphs[i];
+        arena::release(glyph);
+        glyph = arena::allocate(length);
+        if (glyph == arena::INVALID_HANDLE) {
+            continue;
+        }
+
+        for (uint8_t c = 0; c != length; ++c) {
+            arena::get(glyph)[c] = eeprom::readByte(stored + c);
+        }
+    }
+}
+
+bool octoglow::front_display::settings::saveSplashText(const uint8_t *const characterCodes) {
+    uint8_t length = 0;
+    while (length != display::NUM_OF_CHARACTERS and characterCodes[length] != 0) {
+        ++length;
+    }
+    return put(Key::SPLASH_TEXT, characterCodes, length);
+}
+
+bool octoglow::front_display::settings::showSplashText() {
+    uint8_t length;
+    const uint16_t stored = find(Key::SPLASH_TEXT, length);
+
+    if (stored == 0 or length == 0 or length > display::NUM_OF_CHARACTERS) {
+        return false;
+    }
+
+    uint8_t text[display::NUM_OF_CHARACTERS + 1];
+    for (uint8_t i = 0; i != length; ++i) {
+        text[i] = eeprom::readByte(stored + i);
+    }
+    text[length] = 0;
+
+    display::writeStaticCharacters(0, display::NUM_OF_CHARACTERS, text);
+    return true;
+}
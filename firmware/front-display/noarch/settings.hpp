@@ -0,0 +1,64 @@
+#pragma once
+
+#include "protocol.hpp"
+
+#include <inttypes.h>
+
+/*
+ * Key-value store of the settings restored at power-on, kept in the EEPROM.
+ *
+ * The store is a log of records: key, data length and data. Changing a setting appends a new record, the last one
+ * of each key is valid, so the writes are spread over the whole bank instead of wearing the same cells. When the bank
+ * is full, the valid records are copied to the other bank, which then becomes active. Each bank starts with its
+ * generation number; the record key and the new generation are written last, so an interrupted write leaves
+ * the previous state intact.
+ */
+namespace octoglow::front_display::settings {
+
+    enum class Key : uint8_t {
+        BRIGHTNESS,
+        SCROLLING_SLOTS,
+        SPLASH_TEXT,
+        FIRST_GLYPH, // followed by the other user glyphs
+    };
+
+    constexpr uint8_t NUMBER_OF_KEYS = static_cast<uint8_t>(Key::FIRST_GLYPH) + protocol::glyph::MAX_NUMBER_OF_GLYPHS;
+
+    /**
+     * Finds the active bank. Has to be called before the other functions.
+     */
+    void init();
+
+    /**
+     * Stores the setting, unless it has the same value already. Zero length removes the setting.
+     * @return false if the setting doesn't fit the bank together with the other ones
+     */
+    bool put(Key key, const uint8_t *data, uint8_t length);
+
+    /**
+     * @return EEPROM address of the setting data or 0 if the setting is not stored
+     */
+    uint16_t find(Key key, uint8_t &length);
+
+    /**
+     * Stores the brightness, the scrolling slot configuration and the user glyphs.
+     */
+    void saveDisplayState();
+
+    /**
+     * Restores the settings stored by saveDisplayState().
+     */
+    void restoreDisplayState();
+
+    /**
+     * Stores the zero-terminated character codes shown at power-on. Empty text removes the splash text.
+     * @return false if the text doesn't fit the bank
+     */
+    bool saveSplashText(const uint8_t *characterCodes);
+
+    /**
+     * Writes the splash text from the beginning of the display.
+     * @return false if there is no splash text
+     */
+    bool showSplashText();
+}
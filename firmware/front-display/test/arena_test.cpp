@@ -0,0 +1,68 @@
+#include "arena.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace octoglow::front_display;
+
+TEST(Arena, AllocateAndRelease) {
+    arena::init();
+    ASSERT_EQ(arena::SIZE, arena::available());
+
+    arena::Handle a = arena::allocate(10);
+    arena::Handle b = arena::allocate(20);
+    ASSERT_NE(arena::INVALID_HANDLE, a);
+    ASSERT_NE(arena::INVALID_HANDLE, b);
+    ASSERT_EQ(arena::SIZE - 30, arena::available());
+
+    memset(arena::get(b), 0xab, 20);
+
+    arena::release(a);
+    ASSERT_EQ(arena::INVALID_HANDLE, a);
+    ASSERT_EQ(arena::SIZE - 20, arena::available());
+
+    // the following block is moved down, the content is preserved
+    for (uint8_t i = 0; i < 20; ++i) {
+        ASSERT_EQ(0xab, arena::get(b)[i]);
+    }
+
+    ASSERT_EQ(arena::INVALID_HANDLE, arena::allocate(arena::SIZE));
+    arena::release(b);
+    ASSERT_EQ(arena::SIZE, arena::available());
+
+    arena::Handle invalid = arena::INVALID_HANDLE;
+    arena::release(invalid);
+    ASSERT_EQ(arena::SIZE, arena::available());
+}
+
+TEST(Arena, Resize) {
+    arena::init();
+
+    const arena::Handle a = arena::allocate(4);
+    const arena::Handle b = arena::allocate(3);
+    memcpy(arena::get(a), "abcd", 4);
+    memcpy(arena::get(b), "xyz", 3);
+
+    ASSERT_TRUE(arena::resize(a, 8));
+    ASSERT_EQ(8, arena::size(a));
+    ASSERT_EQ(0, memcmp(arena::get(a), "abcd", 4));
+    ASSERT_EQ(0, memcmp(arena::get(b), "xyz", 3));
+
+    ASSERT_TRUE(arena::resize(a, 2));
+    ASSERT_EQ(0, memcmp(arena::get(a), "ab", 2));
+    ASSERT_EQ(0, memcmp(arena::get(b), "xyz", 3));
+    ASSERT_EQ(arena::SIZE - 5, arena::available());
+
+    ASSERT_FALSE(arena::resize(b, arena::SIZE));
+    ASSERT_EQ(3, arena::size(b));
+}
+
+TEST(Arena, OutOfHandles) {
+    arena::init();
+
+    for (uint8_t i = 0; i < arena::MAX_ALLOCATIONS; ++i) {
+        ASSERT_NE(arena::INVALID_HANDLE, arena::allocate(1));
+    }
+    ASSERT_EQ(arena::INVALID_HANDLE, arena::allocate(1));
+
+    arena::init();
+}
@@ -1,9 +1,13 @@
+#include "Font5x7.hpp"
 #include "display.hpp"
 #include "encoder.hpp"
+#include "protocol.hpp"
 
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <cstring>
+#include <vector>
 
 using namespace octoglow::front_display;
 
@@ -23,6 +27,17 @@ encoder::ButtonState encoder::getButtonStateAndClear() {
     return v;
 }
 
+/**
+ * Builds all grids the way the refresh interrupt does.
+ */
+static uint8_t (&wireImage())[display::NUM_OF_CHARACTERS][display::WIRE_IMAGE_BYTES_PER_GRID] {
+    static uint8_t image[display::NUM_OF_CHARACTERS][display::WIRE_IMAGE_BYTES_PER_GRID];
+    for (uint8_t p = 0; p != display::NUM_OF_CHARACTERS; ++p) {
+        display::_buildGridImage(p, image[p]);
+    }
+    return image;
+}
+
 
 TEST(Display, Clear) {
     display::writeStaticText(5, 10, const_cast<char *>("lorem ipsum dolor "));
@@ -56,3 +71,671 @@ TEST(Display, ForEachUtf8character) {
                                    });
     ASSERT_EQ(5, numOfCalls);
 }
+
+TEST(Display, CharacterCodeOf) {
+    for (uint8_t i = 0; i != display::NUMBER_OF_UNICODE_GLYPHS; ++i) {
+        ASSERT_EQ(display::UNICODE_START_CODE + i, display::_characterCodeOf(display::UNICODE_GLYPHS[i]));
+    }
+
+    for (const auto &alias : display::UNICODE_ALIASES) {
+        ASSERT_EQ(alias.characterCode, display::_characterCodeOf(alias.codePoint));
+    }
+
+    ASSERT_EQ(display::INVALID_CHARACTER_CODE, display::_characterCodeOf(0x0));
+    ASSERT_EQ(display::INVALID_CHARACTER_CODE, display::_characterCodeOf(0x0e9)); // é
+    ASSERT_EQ(display::INVALID_CHARACTER_CODE, display::_characterCodeOf(0x4e2d));
+}
+
+static std::vector<uint8_t> decodeUtf8(const char *text, const uint8_t maxLength = 40) {
+    std::vector<uint8_t> codes;
+    display::_forEachUtf8character(text, false, maxLength, &codes,
+                                   [](void *s, uint8_t pos, uint8_t code) -> void {
+                                       auto *c = static_cast<std::vector<uint8_t> *>(s);
+                                       ASSERT_EQ(c->size(), pos);
+                                       c->push_back(code);
+                                   });
+    return codes;
+}
+
+TEST(Display, ForEachUtf8characterMultiByte) {
+    constexpr uint8_t INVALID = display::INVALID_CHARACTER_CODE;
+    const uint8_t degree = display::_characterCodeOf(0x0b0);
+    const uint8_t euro = display::_characterCodeOf(0x20ac);
+    const uint8_t rightArrow = display::_characterCodeOf(0x2192);
+
+    ASSERT_EQ(std::vector<uint8_t>({'a', display::UNICODE_START_CODE + 1, 'b'}), decodeUtf8("a\xc4\x85" "b"));
+    ASSERT_EQ(std::vector<uint8_t>({'5', euro, ' ', rightArrow, ' ', '2', degree}), decodeUtf8("5€ → 2°"));
+    ASSERT_EQ(std::vector<uint8_t>({'-', '"', 'x', '"'}), decodeUtf8("—„x”"));
+
+    // no glyph, 3- and 4-byte sequences are consumed as a whole
+    ASSERT_EQ(std::vector<uint8_t>({INVALID, 'a', INVALID, 'b', INVALID, 'c'}), decodeUtf8("\xe4\xb8\xad" "a" "é" "b" "\xf0\x9f\x98\x80" "c"));
+
+    // truncated sequences at the end and in the middle of the string
+    ASSERT_EQ(std::vector<uint8_t>({'a', INVALID}), decodeUtf8("a\xc4"));
+    ASSERT_EQ(std::vector<uint8_t>({'a', INVALID}), decodeUtf8("a\xe2\x82"));
+    ASSERT_EQ(std::vector<uint8_t>({INVALID, 'z'}), decodeUtf8("\xe2\x82" "z"));
+
+    // stray continuation byte
+    ASSERT_EQ(std::vector<uint8_t>({INVALID, 'q'}), decodeUtf8("\x82" "q"));
+
+    ASSERT_EQ(std::vector<uint8_t>({euro, euro}), decodeUtf8("€€€", 2));
+}
+
+TEST(Display, ConvertUtf8InPlace) {
+    constexpr uint8_t INVALID = display::INVALID_CHARACTER_CODE;
+
+    uint8_t text[] = "a\xc4\x85\xe2\x82\xac\xc4" "b\x82";
+    display::convertUtf8InPlace(text);
+
+    const uint8_t expected[] = {'a', display::UNICODE_START_CODE + 1, display::_characterCodeOf(0x20ac), INVALID, 'b',
+                                INVALID, 0};
+    ASSERT_EQ(0, memcmp(expected, text, sizeof(expected)));
+
+    display::Utf8Decoder decoder{};
+    uint8_t codes[2];
+    ASSERT_EQ(0, decoder.decode(0xe2, codes));
+    ASSERT_EQ(0, decoder.decode(0x82, codes));
+    ASSERT_EQ(2, decoder.decode(0, codes));
+    ASSERT_EQ(INVALID, codes[0]);
+    ASSERT_EQ(0, codes[1]);
+}
+
+TEST(Display, UserGlyphInScrollingText) {
+    display::clear();
+
+    const uint8_t narrowGlyph[] = {0x7f, 0x41, 0x7f};
+    display::uploadGlyph(0, sizeof(narrowGlyph), narrowGlyph);
+
+    ASSERT_EQ(display::USER_GLYPH_START_CODE, display::_characterCodeOf(protocol::glyph::FIRST_CODE_POINT));
+    ASSERT_EQ(display::INVALID_CHARACTER_CODE,
+              display::_characterCodeOf(protocol::glyph::FIRST_CODE_POINT + protocol::glyph::MAX_NUMBER_OF_GLYPHS));
+
+    display::writeScrollingText(0, 0, 2, "\xee\x80\x80" "abc");
+    ASSERT_EQ(4, display::_scrollingSlots[0].textLength);
+
+    // narrower glyph is padded with blank columns
+    const uint8_t expected[] = {0x7f, 0x41, 0x7f, 0, 0};
+    ASSERT_EQ(0, memcmp(expected, display::_frameBuffer, sizeof(expected)));
+
+    display::clear();
+    display::uploadGlyph(0, 0, nullptr);
+}
+
+TEST(Display, PatchFrame) {
+    using namespace protocol::patch;
+    display::clear();
+
+    const uint8_t patch[] = {
+            3, 1, 0x11, 0x22, // literal run of 2 at column 3
+            1, REPEAT_FLAG | 63, 0x7f, // 64 columns of 0x7f from column 6
+            129, XOR_FLAG | REPEAT_FLAG | 0, 0x01, // last column XORed
+    };
+    ASSERT_TRUE(display::patchFrame(patch, sizeof(patch)));
+
+    ASSERT_EQ(0, display::_frameBuffer[2]);
+    ASSERT_EQ(0x11, display::_frameBuffer[3]);
+    ASSERT_EQ(0x22, display::_frameBuffer[4]);
+    ASSERT_EQ(0, display::_frameBuffer[5]);
+    for (uint8_t c = 6; c < 70; ++c) {
+        ASSERT_EQ(0x7f, display::_frameBuffer[c]);
+    }
+    ASSERT_EQ(0, display::_frameBuffer[70]);
+    ASSERT_EQ(0x01, display::_frameBuffer[199]);
+
+    uint8_t lastGridBits = 0;
+    for (const uint8_t b : wireImage()[39]) {
+        lastGridBits |= b;
+    }
+    ASSERT_NE(0, lastGridBits);
+
+    const uint8_t xorPatch[] = {6, XOR_FLAG | 1, 0x0f, 0x70};
+    ASSERT_TRUE(display::patchFrame(xorPatch, sizeof(xorPatch)));
+    ASSERT_EQ(0x70, display::_frameBuffer[6]);
+    ASSERT_EQ(0x0f, display::_frameBuffer[7]);
+
+    // rejected patches leave the framebuffer untouched
+    uint8_t before[display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER];
+    memcpy(before, display::_frameBuffer, sizeof(before));
+
+    const uint8_t pastTheEnd[] = {0, 0, 0x55, 198, 1, 0x55, 0x55};
+    ASSERT_FALSE(display::patchFrame(pastTheEnd, sizeof(pastTheEnd)));
+    const uint8_t truncated[] = {0, 0, 0x55, 0, 3, 0x55, 0x55};
+    ASSERT_FALSE(display::patchFrame(truncated, sizeof(truncated)));
+
+    ASSERT_EQ(0, memcmp(before, display::_frameBuffer, sizeof(before)));
+}
+
+TEST(Display, WireImage) {
+    display::clear();
+
+    for (auto &grid : wireImage()) {
+        for (const uint8_t b : grid) {
+            ASSERT_EQ(0, b);
+        }
+    }
+
+    const uint8_t fullCharacter[] = {0x7f, 0x7f, 0x7f, 0x7f, 0x7f};
+    display::drawGraphics(2 * display::COLUMNS_IN_CHARACTER, sizeof(fullCharacter), false, fullCharacter);
+
+    ASSERT_EQ(0xff, wireImage()[2][0]);
+    ASSERT_EQ(0xff, wireImage()[2][1]);
+    ASSERT_EQ(0x33, wireImage()[2][2]); // dummy bits are always zero
+    ASSERT_EQ(0xff, wireImage()[2][3]);
+    ASSERT_EQ(0xfe, wireImage()[2][4]);
+
+    const uint8_t topLeftDot = 0x01;
+    display::drawGraphics(0, 1, false, &topLeftDot);
+    ASSERT_EQ(0x02, wireImage()[0][4]);
+
+    display::setUpperBarContent(0b11ul | (1ul << 19));
+    ASSERT_EQ(0x03, wireImage()[0][4]);
+    ASSERT_EQ(0x01, wireImage()[1][4]);
+    ASSERT_EQ(0xfe, wireImage()[2][4]);
+    ASSERT_EQ(0x01, wireImage()[19][4]);
+    ASSERT_EQ(0x00, wireImage()[20][4]);
+
+    display::writeStaticText(2, 1, const_cast<char *>(" "));
+    for (const uint8_t b : wireImage()[2]) {
+        ASSERT_EQ(0, b);
+    }
+}
+
+TEST(Display, PoolScrollsOnFrameTicks) {
+    display::clear();
+    display::writeScrollingText(0, 0, 3, const_cast<char *>("lorem ipsum"));
+    display::setScrollingSpeed(0, display::FRAME_RATE / 2);
+
+    display::pool();
+    ASSERT_EQ(0, display::_scrollingSlots[0].currentShift);
+
+    display::_frameTicks = display::_frameTicks + 1;
+    display::pool();
+    ASSERT_EQ(0, display::_scrollingSlots[0].currentShift);
+
+    display::_frameTicks = display::_frameTicks + 1;
+    display::pool();
+    ASSERT_EQ(1, display::_scrollingSlots[0].currentShift);
+
+    display::pool();
+    ASSERT_EQ(1, display::_scrollingSlots[0].currentShift);
+
+    display::_frameTicks = display::_frameTicks + 5;
+    display::pool();
+    ASSERT_EQ(3, display::_scrollingSlots[0].currentShift);
+}
+
+TEST(Display, IncrementalScrollMatchesFullRender) {
+    display::clear();
+    display::writeScrollingText(1, 2, 4, const_cast<char *>("ąbc dęf"));
+    auto &slot = display::_scrollingSlots[1];
+
+    const uint16_t period = 6 * (7 + 2);
+
+    for (uint16_t step = 0; step < 2 * period + 3; ++step) {
+        slot.scrollAndLoadIntoFramebuffer();
+
+        uint8_t scrolled[4 * display::COLUMNS_IN_CHARACTER];
+        memcpy(scrolled, display::_frameBuffer + 2 * display::COLUMNS_IN_CHARACTER, sizeof(scrolled));
+
+        slot.loadIntoFramebuffer();
+
+        for (uint8_t c = 0; c < sizeof(scrolled); ++c) {
+            ASSERT_EQ(display::_frameBuffer[2 * display::COLUMNS_IN_CHARACTER + c], scrolled[c]) << "step " << step;
+        }
+    }
+
+    ASSERT_EQ((2 * period + 3) % period, slot.currentShift);
+
+    // columns outside the window are untouched
+    for (uint8_t c = 0; c < 2 * display::COLUMNS_IN_CHARACTER; ++c) {
+        ASSERT_EQ(0, display::_frameBuffer[c]);
+    }
+    for (uint8_t c = 6 * display::COLUMNS_IN_CHARACTER; c < 10 * display::COLUMNS_IN_CHARACTER; ++c) {
+        ASSERT_EQ(0, display::_frameBuffer[c]);
+    }
+}
+
+TEST(Display, DiffBarsChart) {
+    display::clear();
+    display::configureChart(0, 10, 4, static_cast<uint8_t>(protocol::chart::Style::DIFF_BARS), 2);
+
+    const int8_t samples[] = {9, 20, protocol::chart::NO_VALUE, 3, 5};
+    display::setChartSamples(0, 3, samples + 2);
+
+    ASSERT_EQ(0, display::_frameBuffer[10]);
+    ASSERT_EQ(0b1000001, display::_frameBuffer[11]);
+    ASSERT_EQ(0b0011000, display::_frameBuffer[12]); // (3 - 5) / 2 = -1
+    ASSERT_EQ(0b0001000, display::_frameBuffer[13]);
+
+    // the newest sample is the reference, all columns change
+    display::appendChartSample(0, 20);
+    ASSERT_EQ(0b1000001, display::_frameBuffer[10]);
+    ASSERT_EQ(0b1111000, display::_frameBuffer[11]);
+    ASSERT_EQ(0b1111000, display::_frameBuffer[12]);
+    ASSERT_EQ(0b0001000, display::_frameBuffer[13]);
+
+    // only the newest samples fitting the chart are kept
+    display::setChartSamples(0, 5, samples);
+    ASSERT_EQ(0b0001111, display::_frameBuffer[10]);
+    ASSERT_EQ(0b1000001, display::_frameBuffer[11]);
+    ASSERT_EQ(0b0011000, display::_frameBuffer[12]);
+    ASSERT_EQ(0b0001000, display::_frameBuffer[13]);
+    ASSERT_EQ(0, display::_frameBuffer[9]);
+    ASSERT_EQ(0, display::_frameBuffer[14]);
+
+    display::clear();
+    display::appendChartSample(0, 1);
+    ASSERT_EQ(0, display::_frameBuffer[13]);
+}
+
+TEST(Display, IncrementalSparklineMatchesFullRender) {
+    display::clear();
+    display::configureChart(1, 37, 30, static_cast<uint8_t>(protocol::chart::Style::SPARKLINE), 3);
+    auto &chart = display::_charts[1];
+
+    for (int16_t step = 0; step < 50; ++step) {
+        const int8_t sample = step % 7 == 0 ? protocol::chart::NO_VALUE : static_cast<int8_t>(step % 25 - 2);
+        display::appendChartSample(1, sample);
+
+        uint8_t appended[30];
+        memcpy(appended, display::_frameBuffer + 37, sizeof(appended));
+
+        chart.loadIntoFramebuffer();
+
+        for (uint8_t c = 0; c < sizeof(appended); ++c) {
+            ASSERT_EQ(display::_frameBuffer[37 + c], appended[c]) << "step " << step;
+        }
+    }
+
+    ASSERT_EQ(0, display::_frameBuffer[66]); // step 49 is NO_VALUE
+    ASSERT_EQ(0b0000001, display::_frameBuffer[65]); // 48 % 25 - 2 = 21, row 6 at most
+    ASSERT_EQ(0, display::_frameBuffer[36]);
+    ASSERT_EQ(0, display::_frameBuffer[67]);
+}
+
+TEST(Display, TwoLinesChart) {
+    display::clear();
+    // lower line can't hold a two-line chart
+    display::configureChart(0, 98, 3, static_cast<uint8_t>(protocol::chart::Style::TWO_LINES), 1);
+    ASSERT_EQ(0, display::_charts[0].width);
+
+    display::configureChart(0, 96, 4, static_cast<uint8_t>(protocol::chart::Style::TWO_LINES), 1);
+    const int8_t samples[] = {10, 0, protocol::chart::NO_VALUE, 3};
+    display::setChartSamples(0, 4, samples);
+
+    ASSERT_EQ(0b1111111, display::_frameBuffer[96]);
+    ASSERT_EQ(0, display::_frameBuffer[196]);
+    ASSERT_EQ(0, display::_frameBuffer[97]);
+    ASSERT_EQ(0b0000111, display::_frameBuffer[197]);
+    ASSERT_EQ(0b0000001, display::_frameBuffer[98]);
+    ASSERT_EQ(0b1000000, display::_frameBuffer[198]);
+    ASSERT_EQ(0b1000000, display::_frameBuffer[99]);
+    ASSERT_EQ(0b0000001, display::_frameBuffer[199]);
+
+    display::configureChart(0, 0, 0, 0, 0);
+    ASSERT_EQ(0, display::_charts[0].width);
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_charts[0].samples);
+}
+
+TEST(Display, TickerScrollsAppendedTextWithoutRestart) {
+    display::clear();
+    display::startTicker(0, 0, 2, 30);
+    auto &slot = display::_scrollingSlots[0];
+
+    // two blanks cover the window
+    const uint8_t capacity = display::tickerFreeSpace(0) + 2;
+    ASSERT_EQ(2, slot.textLength);
+
+    const uint8_t text[] = {'a', 'b', 'c', 0};
+    ASSERT_EQ(3, display::appendTickerCharacters(0, text));
+    ASSERT_EQ(capacity - 5, display::tickerFreeSpace(0));
+
+    for (uint8_t step = 0; step < 12; ++step) {
+        slot.scrollAndLoadIntoFramebuffer();
+    }
+
+    // the blanks have scrolled out and are reclaimed
+    ASSERT_EQ(3, slot.textLength);
+    ASSERT_EQ(capacity - 3, display::tickerFreeSpace(0));
+    for (uint8_t c = 0; c < display::COLUMNS_IN_CHARACTER; ++c) {
+        ASSERT_EQ(pgm_read_byte(display::Font5x7 + display::COLUMNS_IN_CHARACTER * ('a' - ' ') + c),
+                  display::_frameBuffer[c]);
+    }
+
+    // appending doesn't restart the scrolling and the buffer wraps around
+    for (uint16_t step = 0; step < 3 * capacity; ++step) {
+        if (step % 6 == 0) {
+            const uint8_t next[] = {static_cast<uint8_t>('a' + step / 6 % 26), 0};
+            display::appendTickerCharacters(0, next);
+        }
+
+        slot.scrollAndLoadIntoFramebuffer();
+
+        uint8_t scrolled[2 * display::COLUMNS_IN_CHARACTER];
+        memcpy(scrolled, display::_frameBuffer, sizeof(scrolled));
+
+        slot.loadIntoFramebuffer();
+
+        for (uint8_t c = 0; c < sizeof(scrolled); ++c) {
+            ASSERT_EQ(display::_frameBuffer[c], scrolled[c]) << "step " << step;
+        }
+        ASSERT_LE(slot.textLength, 5);
+    }
+
+    // the text runs out, blanks follow
+    for (uint8_t step = 0; step < 30; ++step) {
+        slot.scrollAndLoadIntoFramebuffer();
+    }
+    for (uint8_t c = 0; c < 2 * display::COLUMNS_IN_CHARACTER; ++c) {
+        ASSERT_EQ(0, display::_frameBuffer[c]);
+    }
+
+    display::writeScrollingText(0, 0, 2, const_cast<char *>("abcd"));
+    ASSERT_FALSE(slot.ticker);
+    ASSERT_EQ(0, display::tickerFreeSpace(0));
+    display::clear();
+}
+
+TEST(Display, LayersBlendedOverFramebuffer) {
+    display::clear();
+    const uint8_t graphics[] = {0x7f, 0x7f, 0x7f, 0x7f, 0x7f};
+    display::drawGraphics(0, sizeof(graphics), false, graphics);
+
+    uint8_t baseImage[display::WIRE_IMAGE_BYTES_PER_GRID];
+    memcpy(baseImage, wireImage()[0], sizeof(baseImage));
+
+    // the text layer cell replaces the graphics, the framebuffer is kept
+    display::setTextLayerBlending(static_cast<uint8_t>(protocol::layer::Blending::REPLACE));
+    const uint8_t text[] = {' ', 0};
+    display::writeTextLayer(0, 2, text);
+    ASSERT_NE(arena::INVALID_HANDLE, display::_textLayer);
+    for (const uint8_t b : wireImage()[0]) {
+        ASSERT_EQ(0, b);
+    }
+    ASSERT_EQ(0x7f, display::_frameBuffer[0]);
+
+    // overlay expires and the graphics are back
+    display::setTextLayerBlending(static_cast<uint8_t>(protocol::layer::Blending::OR));
+    const uint8_t overlay[] = {0x7f};
+    display::pool();
+    display::showOverlay(2, sizeof(overlay), static_cast<uint8_t>(protocol::layer::Blending::MASK), 1, overlay);
+    ASSERT_NE(0, memcmp(baseImage, wireImage()[0], sizeof(baseImage)));
+
+    display::_frameTicks = display::_frameTicks + protocol::layer::DURATION_UNIT - 1;
+    display::pool();
+    ASSERT_NE(arena::INVALID_HANDLE, display::_overlay.columns);
+
+    display::_frameTicks = display::_frameTicks + 1;
+    display::pool();
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_overlay.columns);
+    ASSERT_EQ(0, memcmp(baseImage, wireImage()[0], sizeof(baseImage)));
+
+    // transparent cells release the layer
+    display::writeTextLayer(0, 1, text + 1);
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_textLayer);
+
+    display::clear();
+}
+
+TEST(Display, CellAttributes) {
+    display::clear();
+    display::writeStaticText(0, 3, "abc");
+
+    uint8_t image[display::WIRE_IMAGE_BYTES_PER_GRID];
+    memcpy(image, wireImage()[1], sizeof(image));
+
+    display::setCellAttributes(1, 9, protocol::attribute::BLINK_FLAG | protocol::attribute::DIM_FLAG);
+    display::setCellAttributes(9, 2, protocol::attribute::INVERSE_FLAG);
+
+    ASSERT_EQ(0b11111110, display::_blinkingCells[0]);
+    ASSERT_EQ(0b00000001, display::_blinkingCells[1]);
+    ASSERT_TRUE(display::_isCellInSet(display::_dimmedCells, 8));
+    ASSERT_FALSE(display::_isCellInSet(display::_dimmedCells, 9));
+    ASSERT_TRUE(display::_isCellInSet(display::_invertedCells, 10));
+    ASSERT_FALSE(display::_isCellInSet(display::_invertedCells, 11));
+
+    // the content is kept
+    ASSERT_EQ(0, memcmp(image, wireImage()[1], sizeof(image)));
+
+    display::clear();
+    for (uint8_t p = 0; p != display::NUM_OF_CHARACTERS; ++p) {
+        ASSERT_FALSE(display::_isCellInSet(display::_blinkingCells, p));
+        ASSERT_FALSE(display::_isCellInSet(display::_invertedCells, p));
+    }
+}
+
+static void runFrames(const uint8_t frames) {
+    for (uint8_t f = 0; f != frames; ++f) {
+        display::_frameTicks = display::_frameTicks + 1;
+        display::pool();
+    }
+}
+
+TEST(Display, StagingTimeout) {
+    display::clear();
+    display::pool();
+
+    uint8_t oldImage[display::NUM_OF_CHARACTERS][display::WIRE_IMAGE_BYTES_PER_GRID];
+    memcpy(oldImage, wireImage(), sizeof(oldImage));
+
+    display::stageFrame();
+    display::writeStaticText(0, 5, "abcde");
+
+    runFrames(protocol::transition::STAGING_TIMEOUT - 1);
+    ASSERT_TRUE(display::_transition.staging);
+    ASSERT_EQ(0, memcmp(oldImage, wireImage(), sizeof(oldImage)));
+
+    // the master never started the transition, the staged image is shown anyway
+    runFrames(1);
+    ASSERT_FALSE(display::_transition.staging);
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_transition.frozenImage);
+    ASSERT_NE(0, memcmp(oldImage, wireImage(), sizeof(oldImage)));
+
+    display::clear();
+}
+
+TEST(Display, WipeTransition) {
+    display::clear();
+    display::pool();
+    display::writeStaticText(0, display::NUM_OF_CHARACTERS, "0123456789abcdefghij0123456789abcdefghij");
+
+    uint8_t oldImage[display::NUM_OF_CHARACTERS][display::WIRE_IMAGE_BYTES_PER_GRID];
+    memcpy(oldImage, wireImage(), sizeof(oldImage));
+
+    display::stageFrame();
+    display::clear();
+    display::writeStaticText(0, display::NUM_OF_CHARACTERS, "ABCDEFGHIJKLMNOPQRSTABCDEFGHIJKLMNOPQRST");
+    display::setUpperBarContent(1);
+    ASSERT_EQ(0, memcmp(oldImage, wireImage(), sizeof(oldImage)));
+
+    display::startTransition(static_cast<uint8_t>(protocol::transition::Style::WIPE), 1);
+    runFrames(protocol::transition::DURATION_UNIT / 2);
+
+    // the left half of both lines is done, the right one is not touched yet
+    ASSERT_EQ(50, display::_transition.step);
+    ASSERT_NE(0, memcmp(oldImage[0], wireImage()[0], display::WIRE_IMAGE_BYTES_PER_GRID));
+    ASSERT_NE(0, memcmp(oldImage[20], wireImage()[20], display::WIRE_IMAGE_BYTES_PER_GRID));
+    ASSERT_EQ(0, memcmp(oldImage[10], wireImage()[10], display::WIRE_IMAGE_BYTES_PER_GRID));
+    ASSERT_EQ(0, memcmp(oldImage[39], wireImage()[39], display::WIRE_IMAGE_BYTES_PER_GRID));
+
+    runFrames(protocol::transition::DURATION_UNIT / 2);
+    ASSERT_FALSE(display::_transition.running);
+
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_transition.frozenImage);
+    ASSERT_EQ(1, wireImage()[0][4] & 1);
+
+    display::clear();
+}
+
+TEST(Display, SlideTransition) {
+    display::clear();
+    display::pool();
+
+    const uint8_t oldColumns[] = {0x01, 0x02, 0x04, 0x08, 0x10};
+    const uint8_t newColumns[] = {0x40, 0x41, 0x42, 0x43, 0x44};
+    const uint8_t slidOnce[] = {0x02, 0x04, 0x08, 0x10, 0x40};
+
+    display::drawGraphics(display::COLUMNS_IN_CHARACTER, sizeof(slidOnce), false, slidOnce);
+    uint8_t expected[display::WIRE_IMAGE_BYTES_PER_GRID];
+    memcpy(expected, wireImage()[1], sizeof(expected));
+
+    display::drawGraphics(0, sizeof(oldColumns), false, oldColumns);
+    display::stageFrame();
+    display::drawGraphics(0, sizeof(newColumns), false, newColumns);
+
+    display::startTransition(static_cast<uint8_t>(protocol::transition::Style::SLIDE), 1);
+    runFrames(protocol::transition::DURATION_UNIT / display::COLUMNS_IN_CHARACTER);
+    ASSERT_EQ(1, display::_transition.step);
+    ASSERT_EQ(0, memcmp(expected, wireImage()[0], sizeof(expected)));
+
+    runFrames(protocol::transition::DURATION_UNIT);
+    ASSERT_FALSE(display::_transition.running);
+
+    display::clear();
+}
+
+TEST(Display, DissolveTransition) {
+    display::clear();
+    display::pool();
+
+    display::stageFrame();
+    const uint8_t full[] = {0x7f, 0x7f, 0x7f, 0x7f, 0x7f};
+    for (uint8_t p = 0; p != display::NUM_OF_CHARACTERS; ++p) {
+        display::drawGraphics(display::COLUMNS_IN_CHARACTER * p, sizeof(full), false, full);
+    }
+
+    display::startTransition(static_cast<uint8_t>(protocol::transition::Style::DISSOLVE), 2);
+    runFrames(protocol::transition::DURATION_UNIT);
+
+    // about half of the dots are lit
+    uint16_t litDots = 0;
+    for (uint8_t p = 0; p != display::NUM_OF_CHARACTERS; ++p) {
+        for (uint8_t b = 0; b != display::WIRE_IMAGE_BYTES_PER_GRID; ++b) {
+            litDots += __builtin_popcount(wireImage()[p][b] & display::wireImageDotMask(b));
+        }
+    }
+    ASSERT_GT(litDots, 500);
+    ASSERT_LT(litDots, 900);
+
+    runFrames(protocol::transition::DURATION_UNIT);
+    ASSERT_FALSE(display::_transition.running);
+    for (uint8_t p = 0; p != display::NUM_OF_CHARACTERS; ++p) {
+        ASSERT_EQ(0xff, wireImage()[p][0]);
+    }
+
+    display::clear();
+}
+
+static std::string widgetText(const uint8_t position, const uint8_t width) {
+    std::string text;
+    for (uint8_t p = position; p != position + width; ++p) {
+        char character = '?';
+        for (uint8_t code = ' '; code != 0x7f; ++code) {
+            if (memcmp(display::_frameBuffer + display::COLUMNS_IN_CHARACTER * p,
+                         display::Font5x7 + display::COLUMNS_IN_CHARACTER * (code - ' '),
+                         display::COLUMNS_IN_CHARACTER) == 0) {
+                character = static_cast<char>(code);
+                break;
+            }
+        }
+        text += character;
+    }
+    return text;
+}
+
+TEST(Display, NumberWidget) {
+    display::clear();
+    display::configureNumberWidget(0, 2, 7, 1, 0, 'C');
+    ASSERT_EQ("   0.0C", widgetText(2, 7));
+
+    display::setWidgetValue(0, -215);
+    ASSERT_EQ(" -21.5C", widgetText(2, 7));
+
+    display::setWidgetValue(0, 7);
+    ASSERT_EQ("   0.7C", widgetText(2, 7));
+
+    display::setWidgetValue(0, 1234567);
+    ASSERT_EQ("######C", widgetText(2, 7));
+
+    display::configureNumberWidget(1, 10, 5, 0,
+                                   protocol::widget::PLUS_SIGN_FLAG | protocol::widget::LEADING_ZEROS_FLAG, 0);
+    display::setWidgetValue(1, 42);
+    ASSERT_EQ("+0042", widgetText(10, 5));
+
+    display::configureNumberWidget(2, 20, 12, 0, 0, 0);
+    display::setWidgetValue(2, INT32_MIN);
+    ASSERT_EQ(" -2147483648", widgetText(20, 12));
+
+    // doesn't fit the display
+    display::configureNumberWidget(2, 38, 3, 0, 0, 0);
+    ASSERT_EQ(0, display::_numberWidgets[2].width);
+
+    display::clear();
+}
+
+TEST(Display, NumberWidgetDecimals) {
+    display::clear();
+
+    display::configureNumberWidget(0, 0, 4, 0, 0, 0);
+    display::setWidgetValue(0, 123);
+    ASSERT_EQ(" 123", widgetText(0, 4));
+
+    // only the point fits before the decimals, the integer zero is left out
+    display::configureNumberWidget(0, 0, 4, 3, 0, 0);
+    ASSERT_EQ(4, display::_numberWidgets[0].width);
+    display::setWidgetValue(0, 123);
+    ASSERT_EQ(".123", widgetText(0, 4));
+    display::setWidgetValue(0, 5);
+    ASSERT_EQ(".005", widgetText(0, 4));
+    display::setWidgetValue(0, 1234);
+    ASSERT_EQ("####", widgetText(0, 4));
+    display::setWidgetValue(0, -5);
+    ASSERT_EQ("####", widgetText(0, 4));
+
+    display::configureNumberWidget(1, 10, 4, 2, 0, 'V');
+    display::setWidgetValue(1, 45);
+    ASSERT_EQ(".45V", widgetText(10, 4));
+
+    // no character left for the integer part or more decimals than int32_t has digits
+    display::writeStaticText(20, 4, "abcd");
+    display::configureNumberWidget(2, 20, 4, 4, 0, 0);
+    ASSERT_EQ(0, display::_numberWidgets[2].width);
+    display::configureNumberWidget(2, 20, 4, 3, 0, 'V');
+    ASSERT_EQ(0, display::_numberWidgets[2].width);
+    display::configureNumberWidget(2, 20, 12, 10, 0, 0);
+    ASSERT_EQ(0, display::_numberWidgets[2].width);
+    display::configureNumberWidget(2, 20, 4, 255, 0, 0);
+    ASSERT_EQ(0, display::_numberWidgets[2].width);
+    display::setWidgetValue(2, 1);
+    ASSERT_EQ("abcd", widgetText(20, 4));
+
+    // the digit loop ends within the width even with the decimals which are never accepted
+    display::_numberWidgets[2] = {20, 4, 255, 0, 0, 1, 1};
+    display::_numberWidgets[2].render();
+    ASSERT_EQ("####", widgetText(20, 4));
+
+    display::clear();
+}
+
+TEST(Display, CountingNumberWidget) {
+    display::clear();
+    display::pool();
+    display::configureNumberWidget(0, 0, 5, 0, protocol::widget::COUNTING_FLAG, 0);
+    display::setWidgetValue(0, 1000);
+    ASSERT_EQ("    0", widgetText(0, 5));
+
+    display::_frameTicks = display::_frameTicks + 1;
+    display::pool();
+    ASSERT_EQ("  125", widgetText(0, 5));
+
+    int32_t previous = display::_numberWidgets[0].shownValue;
+    for (uint8_t f = 0; f != 100; ++f) {
+        display::_frameTicks = display::_frameTicks + 1;
+        display::pool();
+        ASSERT_GE(display::_numberWidgets[0].shownValue, previous);
+        previous = display::_numberWidgets[0].shownValue;
+    }
+    ASSERT_EQ(" 1000", widgetText(0, 5));
+
+    display::clear();
+}
@@ -0,0 +1,253 @@
+#include "eeprom.hpp"
+#include "settings.hpp"
+#include "display.hpp"
+#include "Font5x7.hpp"
+#include "protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace octoglow::front_display;
+
+uint8_t eepromContent[eeprom::SIZE];
+
+static struct ErasedEeprom {
+    ErasedEeprom() {
+        memset(eepromContent, 0xff, sizeof(eepromContent));
+    }
+} erasedEeprom;
+
+static bool readyInterruptEnabled = false;
+
+/**
+ * If set, the queued writes are completed at once, otherwise only by completeWrites().
+ */
+static bool writesCompleteImmediately = true;
+
+static unsigned numberOfWrites = 0;
+
+/**
+ * Reads which wait for the write in progress and waits for the write to finish.
+ */
+static unsigned numberOfWaitingReads = 0;
+static unsigned numberOfWaits = 0;
+
+static void completeWrites() {
+    while (readyInterruptEnabled) {
+        eeprom::onReady();
+    }
+}
+
+uint8_t eeprom::hd::read(const uint16_t address) {
+    ++numberOfWaitingReads;
+    return eepromContent[address];
+}
+
+uint8_t eeprom::hd::readWhenReady(const uint16_t address) {
+    return eepromContent[address];
+}
+
+void eeprom::hd::write(const uint16_t address, const uint8_t value) {
+    eepromContent[address] = value;
+    ++numberOfWrites;
+}
+
+void eeprom::hd::enableReadyInterrupt() {
+    readyInterruptEnabled = true;
+    if (writesCompleteImmediately) {
+        completeWrites();
+    }
+}
+
+void eeprom::hd::disableReadyInterrupt() {
+    readyInterruptEnabled = false;
+}
+
+void eeprom::hd::waitForWrite() {
+    ++numberOfWaits;
+    eeprom::onReady();
+}
+
+TEST(Eeprom, WriteQueue) {
+    writesCompleteImmediately = false;
+
+    eeprom::updateByte(500, 1);
+    eeprom::updateByte(501, 2);
+    eeprom::updateByte(500, 3);
+
+    ASSERT_FALSE(eeprom::isIdle());
+    ASSERT_EQ(0xff, eepromContent[500]);
+    // queued writes are visible at once, the newest one wins
+    ASSERT_EQ(3, eeprom::readByte(500));
+    ASSERT_EQ(2, eeprom::readByte(501));
+
+    // full queue makes room by waiting for the oldest writes
+    for (uint8_t i = 0; i != 2 * eeprom::WRITE_QUEUE_LENGTH; ++i) {
+        eeprom::updateByte(400 + i, i);
+    }
+    ASSERT_EQ(3, eepromContent[500]);
+    ASSERT_EQ(7, eepromContent[407]);
+    ASSERT_EQ(0xff, eepromContent[408]);
+    ASSERT_EQ(8, eeprom::readByte(408));
+
+    completeWrites();
+    writesCompleteImmediately = true;
+
+    ASSERT_TRUE(eeprom::isIdle());
+    ASSERT_EQ(3, eepromContent[500]);
+    ASSERT_EQ(2, eepromContent[501]);
+    ASSERT_EQ(15, eepromContent[415]);
+
+    // unchanged bytes are not written
+    numberOfWrites = 0;
+    eeprom::updateByte(500, 3);
+    ASSERT_EQ(0u, numberOfWrites);
+}
+
+TEST(Eeprom, UpdateDoesNotWait) {
+    writesCompleteImmediately = false;
+    numberOfWrites = 0;
+    numberOfWaitingReads = 0;
+    numberOfWaits = 0;
+
+    // more unchanged bytes than the queue holds, they are dropped without writing and without reading the EEPROM
+    constexpr uint8_t NUMBER_OF_BYTES = 4 * eeprom::WRITE_QUEUE_LENGTH;
+    for (uint8_t i = 0; i != NUMBER_OF_BYTES; ++i) {
+        eeprom::updateByte(200 + i, eepromContent[200 + i]);
+    }
+    completeWrites();
+
+    ASSERT_EQ(0u, numberOfWaitingReads);
+    ASSERT_EQ(0u, numberOfWrites);
+
+    // changed bytes wait only when the queue is full, one write at a time, so the watchdog is reset between them
+    numberOfWaits = 0;
+    for (uint8_t i = 0; i != NUMBER_OF_BYTES; ++i) {
+        eeprom::updateByte(200 + i, i);
+    }
+
+    ASSERT_EQ(0u, numberOfWaitingReads);
+    ASSERT_EQ(NUMBER_OF_BYTES - eeprom::WRITE_QUEUE_LENGTH, numberOfWaits);
+    ASSERT_EQ(NUMBER_OF_BYTES - eeprom::WRITE_QUEUE_LENGTH, numberOfWrites);
+
+    completeWrites();
+    writesCompleteImmediately = true;
+
+    ASSERT_EQ(NUMBER_OF_BYTES, numberOfWrites);
+    for (uint8_t i = 0; i != NUMBER_OF_BYTES; ++i) {
+        ASSERT_EQ(i, eepromContent[200 + i]);
+        eeprom::updateByte(200 + i, 0xff);
+    }
+}
+
+TEST(Settings, PutAndFind) {
+    settings::init();
+
+    const uint8_t value[] = {1, 2, 3};
+    ASSERT_TRUE(settings::put(settings::Key::SPLASH_TEXT, value, 3));
+
+    uint8_t length;
+    const uint16_t address = settings::find(settings::Key::SPLASH_TEXT, length);
+    ASSERT_NE(0, address);
+    ASSERT_EQ(3, length);
+    ASSERT_EQ(2, eeprom::readByte(address + 1));
+
+    // the same value is not written again
+    numberOfWrites = 0;
+    ASSERT_TRUE(settings::put(settings::Key::SPLASH_TEXT, value, 3));
+    ASSERT_EQ(0u, numberOfWrites);
+
+    ASSERT_TRUE(settings::put(settings::Key::SPLASH_TEXT, nullptr, 0));
+    settings::find(settings::Key::SPLASH_TEXT, length);
+    ASSERT_EQ(0, length);
+}
+
+TEST(Settings, WearLevelling) {
+    settings::init();
+
+    const uint8_t other[] = {7, 7, 7, 7};
+    settings::put(settings::Key::SCROLLING_SLOTS, other, 4);
+
+    uint8_t bankWrites[2 * eeprom::SETTINGS_BANK_SIZE] = {};
+
+    // the log moves over both banks, the last value is always found, also after power-on
+    for (uint8_t brightness = 0; brightness != 200; ++brightness) {
+        uint8_t before[2 * eeprom::SETTINGS_BANK_SIZE];
+        memcpy(before, eepromContent + eeprom::SETTINGS_ADDRESS, sizeof(before));
+
+        ASSERT_TRUE(settings::put(settings::Key::BRIGHTNESS, &brightness, 1));
+
+        for (uint8_t i = 0; i != sizeof(before); ++i) {
+            bankWrites[i] += before[i] != eepromContent[eeprom::SETTINGS_ADDRESS + i] ? 1 : 0;
+        }
+
+        settings::init();
+
+        uint8_t length;
+        const uint16_t address = settings::find(settings::Key::BRIGHTNESS, length);
+        ASSERT_EQ(1, length);
+        ASSERT_EQ(brightness, eeprom::readByte(address));
+
+        ASSERT_NE(0, settings::find(settings::Key::SCROLLING_SLOTS, length));
+        ASSERT_EQ(4, length);
+    }
+
+    // 200 changes of a single setting, no cell is written more than a small fraction of that
+    for (const uint8_t writes : bankWrites) {
+        ASSERT_LT(writes, 20);
+    }
+
+    // too much data for the bank is rejected, the old settings are kept
+    uint8_t large[eeprom::SETTINGS_BANK_SIZE];
+    memset(large, 1, sizeof(large));
+    ASSERT_FALSE(settings::put(settings::Key::SPLASH_TEXT, large, sizeof(large) - 5));
+    uint8_t length;
+    ASSERT_NE(0, settings::find(settings::Key::SCROLLING_SLOTS, length));
+}
+
+TEST(Settings, DisplayState) {
+    settings::init();
+    display::clear();
+
+    const uint8_t glyph[] = {0x11, 0x22, 0x33};
+    display::uploadGlyph(2, 3, glyph);
+    display::setBrightness(protocol::brightness::FINE_LEVEL_FLAG | 21);
+    const uint8_t capacities[] = {30, 40};
+    display::configureScrollingSlots(2, capacities);
+
+    settings::saveDisplayState();
+
+    const uint8_t splash[] = {'h', 'e', 'l', 'l', 'o', 0};
+    ASSERT_TRUE(settings::saveSplashText(splash));
+
+    display::uploadGlyph(2, 0, nullptr);
+    display::setBrightness(protocol::brightness::FINE_LEVEL_FLAG | 50);
+    const uint8_t defaultCapacities[] = {protocol::scroll::SLOT0_MAX_LENGTH,
+                                         protocol::scroll::SLOT1_MAX_LENGTH,
+                                         protocol::scroll::SLOT2_MAX_LENGTH};
+
+    display::configureScrollingSlots(3, defaultCapacities);
+
+    settings::init();
+    settings::restoreDisplayState();
+
+    ASSERT_EQ(21, display::_brightness);
+    ASSERT_EQ(2, display::_numberOfScrollingSlots);
+    ASSERT_EQ(40, display::_scrollingSlots[1].maxTextLength);
+    ASSERT_EQ(3, arena::size(display::_userGlyphs[2]));
+    ASSERT_EQ(0x22, arena::get(display::_userGlyphs[2])[1]);
+
+    ASSERT_TRUE(settings::showSplashText());
+    ASSERT_EQ(pgm_read_byte(display::Font5x7 + display::COLUMNS_IN_CHARACTER * ('e' - ' ')),
+              display::_frameBuffer[display::COLUMNS_IN_CHARACTER]);
+
+    const uint8_t empty[] = {0};
+    settings::saveSplashText(empty);
+    ASSERT_FALSE(settings::showSplashText());
+
+    display::uploadGlyph(2, 0, nullptr);
+    display::configureScrollingSlots(3, defaultCapacities);
+    display::setBrightness(protocol::brightness::FINE_LEVEL_FLAG | display::MAX_FINE_BRIGHTNESS);
+    display::clear();
+}
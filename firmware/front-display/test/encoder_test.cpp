@@ -0,0 +1,100 @@
+#include "encoder.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace octoglow::front_display;
+
+bool eventPending = false;
+
+void encoder::hd::setEventPending(const bool pending) {
+    eventPending = pending;
+}
+
+encoder::InputLoad encoder::getInputLoadAndClear() {
+    return {100, 2015, 0x12345};
+}
+
+static void drainEvents() {
+    encoder::Event event{};
+    while (encoder::peekEvent(event) != 0) {
+        encoder::popEvent();
+    }
+}
+
+static void step(const encoder::EventType direction, const uint16_t timestamp) {
+    encoder::_position += direction == encoder::EventType::STEP_CW ? 1 : -1;
+    encoder::_pushEvent(direction, timestamp);
+}
+
+TEST(Encoder, EventQueue) {
+    drainEvents();
+    ASSERT_FALSE(eventPending);
+
+    encoder::Event event{};
+    ASSERT_EQ(0, encoder::peekEvent(event));
+    ASSERT_EQ(encoder::EventType::NONE, event.type);
+    const uint8_t firstSequenceNumber = event.sequenceNumber;
+    const int16_t startPosition = encoder::_position;
+
+    // quick press and release between reads are both kept
+    encoder::_pushEvent(encoder::EventType::BUTTON_PRESSED, 100);
+    encoder::_pushEvent(encoder::EventType::BUTTON_RELEASED, 150);
+    ASSERT_TRUE(eventPending);
+
+    // steps in the same direction are merged
+    step(encoder::EventType::STEP_CW, 200);
+    step(encoder::EventType::STEP_CW, 210);
+    step(encoder::EventType::STEP_CW, 220);
+    step(encoder::EventType::STEP_CCW, 230);
+
+    ASSERT_EQ(4, encoder::peekEvent(event));
+    ASSERT_EQ(firstSequenceNumber, event.sequenceNumber);
+    ASSERT_EQ(encoder::EventType::BUTTON_PRESSED, event.type);
+    ASSERT_EQ(100, event.timestamp);
+    encoder::popEvent();
+
+    ASSERT_EQ(3, encoder::peekEvent(event));
+    ASSERT_EQ(encoder::EventType::BUTTON_RELEASED, event.type);
+    encoder::popEvent();
+
+    ASSERT_EQ(2, encoder::peekEvent(event));
+    ASSERT_EQ(firstSequenceNumber + 2, event.sequenceNumber);
+    ASSERT_EQ(encoder::EventType::STEP_CW, event.type);
+    ASSERT_EQ(startPosition + 3, event.position);
+    ASSERT_EQ(220, event.timestamp);
+    encoder::popEvent();
+
+    // the event being read is not merged with the new steps
+    ASSERT_EQ(1, encoder::peekEvent(event));
+    ASSERT_EQ(encoder::EventType::STEP_CCW, event.type);
+    step(encoder::EventType::STEP_CCW, 240);
+    encoder::popEvent();
+
+    ASSERT_EQ(1, encoder::peekEvent(event));
+    ASSERT_EQ(startPosition + 1, event.position);
+    ASSERT_EQ(240, event.timestamp);
+    encoder::popEvent();
+
+    ASSERT_FALSE(eventPending);
+}
+
+TEST(Encoder, EventQueueOverflow) {
+    drainEvents();
+
+    encoder::Event event{};
+    encoder::peekEvent(event);
+    const uint8_t firstSequenceNumber = event.sequenceNumber;
+
+    for (uint8_t i = 0; i < encoder::EVENT_QUEUE_LENGTH + 2; ++i) {
+        encoder::_pushEvent(i % 2 ? encoder::EventType::BUTTON_RELEASED : encoder::EventType::BUTTON_PRESSED, i);
+    }
+
+    ASSERT_EQ(encoder::EVENT_QUEUE_LENGTH, encoder::peekEvent(event));
+    drainEvents();
+
+    // the dropped events used up their sequence numbers
+    encoder::_pushEvent(encoder::EventType::BUTTON_PRESSED, 0);
+    encoder::peekEvent(event);
+    ASSERT_EQ(static_cast<uint8_t>(firstSequenceNumber + encoder::EVENT_QUEUE_LENGTH + 2), event.sequenceNumber);
+    drainEvents();
+}
@@ -0,0 +1,63 @@
+#include "framing.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace octoglow;
+
+static void noop(const uint8_t *, uint8_t *) {
+}
+
+static constexpr framing::CommandDescriptor TABLE[] = {
+        framing::fixed(1, 3, noop, 2),
+        framing::terminated(2, 3, noop, 1, 0x80),
+        framing::counted(3, 2, 3, noop),
+};
+
+static_assert(framing::isValidTable(TABLE));
+
+static constexpr framing::CommandDescriptor GAPPED_TABLE[] = {
+        framing::fixed(1, 1, noop),
+        framing::fixed(3, 1, noop),
+};
+
+static_assert(not framing::isValidTable(GAPPED_TABLE));
+
+TEST(Framing, FindCommand) {
+    framing::CommandDescriptor descriptor{};
+
+    ASSERT_FALSE(framing::findCommand(TABLE, 0, descriptor));
+    ASSERT_FALSE(framing::findCommand(TABLE, 4, descriptor));
+
+    ASSERT_TRUE(framing::findCommand(TABLE, 2, descriptor));
+    ASSERT_EQ(2, descriptor.command);
+    ASSERT_EQ(framing::Framing::TERMINATED, descriptor.framing);
+}
+
+TEST(Framing, FrameLength) {
+    const uint8_t fixedFrame[] = {1, 0, 0, 0};
+    ASSERT_EQ(3, framing::frameLength(TABLE[0], fixedFrame, sizeof(fixedFrame)));
+    ASSERT_EQ(0, framing::frameLength(TABLE[0], fixedFrame, 2));
+
+    const uint8_t text[] = {2, 0, 'a', 0, 'b'};
+    ASSERT_EQ(4, framing::frameLength(TABLE[1], text, sizeof(text)));
+
+    // the flag adds the optional byte, which can be zero
+    const uint8_t textWithOptionalByte[] = {2, 0x80, 0, 0};
+    ASSERT_EQ(4, framing::frameLength(TABLE[1], textWithOptionalByte, sizeof(textWithOptionalByte)));
+
+    const uint8_t counted[] = {3, 7, 2, 0xaa, 0xbb, 0xcc};
+    ASSERT_EQ(5, framing::frameLength(TABLE[2], counted, sizeof(counted)));
+
+    const uint8_t countedEmpty[] = {3, 7, 0};
+    ASSERT_EQ(3, framing::frameLength(TABLE[2], countedEmpty, sizeof(countedEmpty)));
+}
+
+TEST(Framing, SealResponse) {
+    uint8_t response[] = {0, 1, 0x12, 0x34};
+
+    ASSERT_EQ(4, framing::sealResponse(response, 2));
+    ASSERT_EQ(framing::crc8(&response[1], 3), response[0]);
+
+    ASSERT_EQ(0x07, framing::crc8ccittUpdate(0, 1));
+    ASSERT_EQ(0xf4, framing::crc8(reinterpret_cast<const uint8_t *>("123456789"), 9));
+}
@@ -3,13 +3,20 @@
 #include "eeprom.hpp"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
 #include <cstdint>
+#include <vector>
 
 #include "encoder.hpp"
+#include "protocol.hpp"
+#include "arena.hpp"
+#include "framing.hpp"
+#include "Font5x7.hpp"
 
 using namespace octoglow::front_display;
 using namespace octoglow::front_display::i2c;
+using octoglow::framing::crc8ccittUpdate;
 
 static void assertReadIs(const uint8_t expected) {
     uint8_t readValue;
@@ -25,6 +32,12 @@ static void assertFramebufferIsEmpty() {
     }
 }
 
+static uint8_t gridBits(const uint8_t position) {
+    uint8_t image[display::WIRE_IMAGE_BYTES_PER_GRID];
+    display::_buildGridImage(position, image);
+    return image[0] | image[1];
+}
+
 static uint8_t endYearOfConstruction = 77;
 
 uint8_t eeprom::readEndYearOfConstruction() {
@@ -35,23 +48,32 @@ void eeprom::saveEndYearOfConstruction(const uint8_t year) {
     endYearOfConstruction = year;
 }
 
-uint8_t i2c::crc8ccittUpdate(const uint8_t inCrc, const uint8_t inData) {
-    uint8_t data = inCrc ^ inData;
-    for (int i = 0; i < 8; i++) {
-        if ((data & 0x80) != 0) {
-            data <<= 1;
-            data ^= 0x07;
-        } else {
-            data <<= 1;
-        }
+BusLoad i2c::getBusLoadAndClear() {
+    return {40, 180, 0x1234};
+}
+
+/**
+ * Sends the command with the payload, prepended by the calculated CRC.
+ */
+static void sendCommand(const std::vector<uint8_t> &commandAndPayload) {
+    uint8_t crc = 0;
+    for (const uint8_t b : commandAndPayload) {
+        crc = crc8ccittUpdate(crc, b);
     }
-    return data;
+
+    onStart();
+    onReceive(crc);
+    for (const uint8_t b : commandAndPayload) {
+        onReceive(b);
+    }
+    processDataIfAvailable();
 }
 
 TEST(I2C, GetEncoderState) {
     onStart();
     onReceive(0x7);
     onReceive(0x1);
+    processDataIfAvailable();
 
     onStart();
     assertReadIs(107);
@@ -62,6 +84,7 @@ TEST(I2C, GetEncoderState) {
     onStart();
     onReceive(0x7);
     onReceive(0x1);
+    processDataIfAvailable();
 
     onStart();
     assertReadIs(107);
@@ -75,6 +98,7 @@ TEST(I2C, GetEncoderState) {
     onStart();
     onReceive(0x7);
     onReceive(0x1);
+    processDataIfAvailable();
 
     onStart();
     assertReadIs(83);
@@ -85,6 +109,7 @@ TEST(I2C, GetEncoderState) {
     onStart();
     onReceive(0x7);
     onReceive(0x1);
+    processDataIfAvailable();
 
     onStart();
     assertReadIs(107);
@@ -99,6 +124,7 @@ TEST(I2C, ClearDisplay) {
     onStart();
     onReceive(14);
     onReceive(2);
+    processDataIfAvailable();
 
     assertFramebufferIsEmpty();
 
@@ -112,15 +138,35 @@ TEST(I2C, SetBrightness) {
     onReceive(56);
     onReceive(0x3);
     onReceive(1);
+    processDataIfAvailable();
 
-    ASSERT_EQ(1, display::_brightness);
+    ASSERT_EQ(1 * display::MAX_FINE_BRIGHTNESS / display::MAX_BRIGHTNESS, display::_brightness);
 
     onStart();
     onReceive(35);
     onReceive(0x3);
     onReceive(4);
+    processDataIfAvailable();
+
+    ASSERT_EQ(4 * display::MAX_FINE_BRIGHTNESS / display::MAX_BRIGHTNESS, display::_brightness);
+
+    onStart();
+    assertReadIs(9);
+    assertReadIs(3);
+}
+
+TEST(I2C, SetFineBrightness) {
+    sendCommand({3, protocol::brightness::FINE_LEVEL_FLAG | 40});
+    ASSERT_EQ(40, display::_brightness);
+
+    sendCommand({3, protocol::brightness::FINE_LEVEL_FLAG | 0x7f});
+    ASSERT_EQ(display::MAX_FINE_BRIGHTNESS, display::_brightness);
+
+    sendCommand({3, protocol::brightness::FINE_LEVEL_FLAG});
+    ASSERT_EQ(0, display::_brightness);
 
-    ASSERT_EQ(4, display::_brightness);
+    sendCommand({3, 200});
+    ASSERT_EQ(display::MAX_FINE_BRIGHTNESS, display::_brightness);
 
     onStart();
     assertReadIs(9);
@@ -137,6 +183,7 @@ TEST(I2C, SetUpperBar) {
     onReceive(0xff);
     onReceive(0xff);
     onReceive(0x0f);
+    processDataIfAvailable();
     ASSERT_EQ(0x0fffff, display::_upperBarBuffer);
 
     // all segments disabled
@@ -146,6 +193,7 @@ TEST(I2C, SetUpperBar) {
     onReceive(0);
     onReceive(0);
     onReceive(0);
+    processDataIfAvailable();
     ASSERT_EQ(0, display::_upperBarBuffer);
 
     onStart();
@@ -154,6 +202,7 @@ TEST(I2C, SetUpperBar) {
     onReceive(0xab);
     onReceive(0xcd);
     onReceive(0x0e);
+    processDataIfAvailable();
 
     ASSERT_EQ(0x0ecdab, display::_upperBarBuffer);
 
@@ -176,6 +225,7 @@ TEST(I2C, DrawGraphics) {
     onReceive(0xef);
     onReceive(0xab);
     onReceive(0xcd);
+    processDataIfAvailable();
 
     ASSERT_EQ(0, display::_frameBuffer[0]);
     ASSERT_EQ(0xab, display::_frameBuffer[1]);
@@ -201,10 +251,12 @@ TEST(I2C, WriteStaticText) {
     onReceive('a');
     onReceive('b');
     onReceive('c');
+    processDataIfAvailable();
 
     assertFramebufferIsEmpty();
 
     onReceive(0);
+    processDataIfAvailable();
 
     for (int pos = 0; pos < 5; ++pos) {
         ASSERT_EQ(0, display::_frameBuffer[pos]);
@@ -252,13 +304,499 @@ TEST(I2C, WriteScrollingText) {
     onReceive('e');
     onReceive('f');
     onReceive(0);
+    processDataIfAvailable();
 
     ASSERT_EQ(3, display::_scrollingSlots[2].startPosition);
-    ASSERT_EQ(6 * 5, display::_scrollingSlots[2].maxTextLength);
+    ASSERT_EQ(protocol::scroll::SLOT2_MAX_LENGTH, display::_scrollingSlots[2].maxTextLength);
+
+    onStart();
+    assertReadIs(27);
+    assertReadIs(5);
+}
+
+TEST(I2C, WriteScrollingTextWithSpeed) {
+    display::clear();
+
+    sendCommand({5, 1 | protocol::scroll::SPEED_FIELD_FLAG, 4, 2, 0, 'a', 'b', 'c', 0});
+
+    ASSERT_EQ(4, display::_scrollingSlots[1].startPosition);
+    ASSERT_EQ(2, display::_scrollingSlots[1].length);
+    ASSERT_EQ(3, display::_scrollingSlots[1].textLength);
+    ASSERT_EQ(0, display::_scrollingSlots[1].speed);
+
+    sendCommand({5, 1 | protocol::scroll::SPEED_FIELD_FLAG, 4, 2, 120, 'a', 'b', 'c', 0});
+    ASSERT_EQ(120, display::_scrollingSlots[1].speed);
+
+    sendCommand({5, 1, 4, 2, 'a', 'b', 'c', 0});
+    ASSERT_EQ(protocol::scroll::DEFAULT_SPEED, display::_scrollingSlots[1].speed);
+
+    onStart();
+    assertReadIs(27);
+    assertReadIs(5);
+}
+
+TEST(I2C, ConfigureScrollingSlots) {
+    display::clear();
+
+    sendCommand({10, 5, 40, 40, 40, 40, 40});
+    ASSERT_EQ(5, display::_numberOfScrollingSlots);
+    ASSERT_EQ(40, display::_scrollingSlots[4].maxTextLength);
+
+    for (uint8_t slot = 0; slot < 5; ++slot) {
+        sendCommand({5, slot, static_cast<uint8_t>(8 * slot), 2, 'l', 'o', 'r', 'e', 'm', 0});
+        ASSERT_EQ(5, display::_scrollingSlots[slot].textLength);
+    }
+    ASSERT_EQ(arena::SIZE - 5 * 5, arena::available());
+
+    // text fits the window, the slot falls back to static mode and its memory is reclaimed
+    sendCommand({5, 2, 16, 8, 'l', 'o', 'r', 'e', 'm', 0});
+    ASSERT_EQ(0, display::_scrollingSlots[2].textLength);
+    ASSERT_EQ(arena::SIZE - 4 * 5, arena::available());
+
+    // single long slot
+    sendCommand({10, 1, 255});
+    ASSERT_EQ(1, display::_numberOfScrollingSlots);
+    ASSERT_EQ(arena::SIZE, arena::available());
+
+    sendCommand({5, 2, 0, 5, 'l', 'o', 'r', 'e', 'm', 0});
+    ASSERT_EQ(0, display::_scrollingSlots[2].textLength);
 
     onStart();
     assertReadIs(27);
     assertReadIs(5);
+
+    const uint8_t defaultCapacities[] = {protocol::scroll::SLOT0_MAX_LENGTH,
+                                         protocol::scroll::SLOT1_MAX_LENGTH,
+                                         protocol::scroll::SLOT2_MAX_LENGTH};
+    display::configureScrollingSlots(protocol::scroll::NUMBER_OF_SLOTS, defaultCapacities);
+}
+
+TEST(I2C, UploadAndDrawGlyph) {
+    display::clear();
+
+    // 7 columns wide glyph with id 1
+    sendCommand({11, 1, 7, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40});
+    ASSERT_EQ(arena::SIZE - 7, arena::available());
+
+    sendCommand({12, 198, 1, 0});
+    ASSERT_EQ(0x01, display::_frameBuffer[198]);
+    ASSERT_EQ(0x02, display::_frameBuffer[199]);
+
+    sendCommand({12, 10, 1, 0});
+    for (uint8_t c = 0; c < 7; ++c) {
+        ASSERT_EQ(1 << c, display::_frameBuffer[10 + c]);
+    }
+
+    // U+E001 in text shows the first character width of the glyph
+    sendCommand({4, 4, 2, 'a', 0xee, 0x80, 0x81, 0});
+    ASSERT_EQ(0x20, display::_frameBuffer[20]);
+    for (uint8_t c = 0; c < 5; ++c) {
+        ASSERT_EQ(1 << c, display::_frameBuffer[25 + c]);
+    }
+
+    // zero width removes the glyph, drawing it does nothing
+    sendCommand({11, 1, 0});
+    ASSERT_EQ(arena::SIZE, arena::available());
+
+    display::clear();
+    sendCommand({12, 0, 1, 0});
+    assertFramebufferIsEmpty();
+}
+
+TEST(I2C, PatchFrame) {
+    using namespace protocol::patch;
+    display::clear();
+
+    // whole display filled in 4 segments, then a single column replaced
+    sendCommand({13, 12,
+                 0, REPEAT_FLAG | 63, 0x41,
+                 0, REPEAT_FLAG | 63, 0x41,
+                 0, REPEAT_FLAG | 63, 0x41,
+                 0, REPEAT_FLAG | 7, 0x41});
+    for (int i = 0; i < display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER; ++i) {
+        ASSERT_EQ(0x41, display::_frameBuffer[i]);
+    }
+
+    sendCommand({13, 3, 100, 0, 0x7f});
+    ASSERT_EQ(0x41, display::_frameBuffer[99]);
+    ASSERT_EQ(0x7f, display::_frameBuffer[100]);
+    ASSERT_EQ(0x41, display::_frameBuffer[101]);
+
+    onStart();
+    assertReadIs(35);
+    assertReadIs(13);
+}
+
+TEST(I2C, PatchWholeFrame) {
+    using namespace protocol::patch;
+    display::clear();
+
+    // every column differs, so no run is repeated: 4 segments of 64, 64, 64 and 8 columns
+    std::vector<uint8_t> patch;
+    for (int column = 0; column != display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER; ++column) {
+        if (column % (RUN_LENGTH_MASK + 1) == 0) {
+            const int runLength = std::min(RUN_LENGTH_MASK + 1, display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER - column);
+            patch.push_back(0);
+            patch.push_back(runLength - 1);
+        }
+        patch.push_back(column % 0x7f + 1);
+    }
+
+    std::vector<uint8_t> frame = {13, static_cast<uint8_t>(patch.size())};
+    frame.insert(frame.end(), patch.begin(), patch.end());
+    sendCommand(frame);
+
+    for (int column = 0; column != display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER; ++column) {
+        ASSERT_EQ(column % 0x7f + 1, display::_frameBuffer[column]);
+    }
+
+    onStart();
+    assertReadIs(35);
+    assertReadIs(13);
+
+    display::clear();
+}
+
+TEST(I2C, Batch) {
+    display::clear();
+
+    sendCommand({14, 16,
+                 2,
+                 4, 1, 2, 'a', 'b', 0,
+                 7, 0b1, 0, 0,
+                 6, 40, 1, 0, 0x7f});
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+    ASSERT_EQ(0x7f, display::_frameBuffer[10]);
+    ASSERT_EQ(1u, display::_upperBarBuffer);
+    ASSERT_EQ(0x7f, display::_frameBuffer[40]);
+    ASSERT_NE(0, gridBits(1));
+
+    onStart();
+    assertReadIs(42);
+    assertReadIs(14);
+
+    // commands responding with data can't be batched, the whole batch is rejected
+    sendCommand({14, 2, 2, 1});
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+
+    // incomplete last command
+    sendCommand({14, 4, 2, 3, 0x80, 4});
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+}
+
+static void appendText(std::vector<uint8_t> &frame, const char *text) {
+    frame.insert(frame.end(), text, text + strlen(text) + 1);
+}
+
+TEST(I2C, BatchWhileScrolling) {
+    display::clear();
+
+    std::vector<uint8_t> scrollingText = {5, 0, 0, 10};
+    appendText(scrollingText, "The quick brown fox jumps over the lazy dog. Pack my box now");
+    sendCommand(scrollingText);
+    ASSERT_EQ(60, display::_scrollingSlots[0].textLength);
+
+    // the page drawn in one batch next to the scrolling text
+    std::vector<uint8_t> commands = {4, 20, 10};
+    appendText(commands, "0123456789");
+    commands.insert(commands.end(), {5, 1, 10, 10});
+    appendText(commands, "Dosc grozb fuzja, klne, pych i malzenstw");
+    commands.insert(commands.end(), {5, 2, 36, 4});
+    appendText(commands, "20 C, wind 5 m/s from SW");
+    commands.insert(commands.end(), {7, 0xff, 0x0f, 0});
+    commands.insert(commands.end(), {6, 150, 30, 0});
+    commands.insert(commands.end(), 30, 0x55);
+
+    std::vector<uint8_t> batch = {14, static_cast<uint8_t>(commands.size())};
+    batch.insert(batch.end(), commands.begin(), commands.end());
+    ASSERT_GT(batch.size(), 100u);
+    sendCommand(batch);
+
+    onStart();
+    assertReadIs(42);
+    assertReadIs(14);
+
+    ASSERT_EQ(60, display::_scrollingSlots[0].textLength);
+    ASSERT_EQ(40, display::_scrollingSlots[1].textLength);
+    ASSERT_EQ(24, display::_scrollingSlots[2].textLength);
+    ASSERT_EQ(0xfffu, display::_upperBarBuffer);
+    ASSERT_EQ(0, memcmp(display::Font5x7 + 5 * ('0' - ' '), &display::_frameBuffer[100], 5));
+    for (int column = 150; column != 180; ++column) {
+        ASSERT_EQ(0x55, display::_frameBuffer[column]);
+    }
+
+    // the batch which doesn't fit next to the texts is refused, not cut short
+    std::vector<uint8_t> graphics = {14, 208};
+    for (int i = 0; i != 2; ++i) {
+        graphics.insert(graphics.end(), {6, 0, 100, 0});
+        graphics.insert(graphics.end(), 100, 0x7f);
+    }
+    sendCommand(graphics);
+    ASSERT_EQ(0x55, display::_frameBuffer[150]);
+    onStart();
+    assertReadIs(crc8ccittUpdate(0, protocol::NO_SPACE_RESPONSE));
+    assertReadIs(protocol::NO_SPACE_RESPONSE);
+
+    display::clear();
+}
+
+TEST(I2C, WriteLongUtf8ScrollingText) {
+    display::clear();
+
+    // two-byte characters, the UTF-8 text is longer than the free space of the arena where the frame is received
+    std::vector<uint8_t> frame = {5, 0, 0, 10};
+    for (int i = 0; i != protocol::scroll::SLOT0_MAX_LENGTH; ++i) {
+        frame.push_back(0xc4);
+        frame.push_back(0x85);
+    }
+    frame.push_back(0);
+    sendCommand(frame);
+
+    ASSERT_EQ(protocol::scroll::SLOT0_MAX_LENGTH, display::_scrollingSlots[0].textLength);
+    ASSERT_EQ(display::UNICODE_START_CODE + 1, arena::get(display::_scrollingSlots[0].convertedText)[0]);
+    ASSERT_EQ(display::UNICODE_START_CODE + 1, arena::get(display::_scrollingSlots[0].convertedText)[protocol::scroll::SLOT0_MAX_LENGTH - 1]);
+
+    onStart();
+    assertReadIs(crc8ccittUpdate(0, 5));
+    assertReadIs(5);
+
+    // truncated sequence right before the terminating zero
+    sendCommand({4, 0, 3, 'a', 0xc4, 0});
+    ASSERT_EQ(0x20, display::_frameBuffer[0]);
+    ASSERT_EQ(0, memcmp(display::Font5x7 + 5 * (display::INVALID_CHARACTER_CODE - ' '), &display::_frameBuffer[5], 5));
+
+    // texts in batches are converted too
+    sendCommand({14, 8, 4, 2, 1, 0xc4, 0x85, 0, 3, 5});
+    ASSERT_EQ(0, memcmp(display::Font5x7 + 5 * (display::UNICODE_START_CODE + 1 - ' '), &display::_frameBuffer[10], 5));
+}
+
+TEST(I2C, OversizeFrameIsRejected) {
+    display::clear();
+
+    // the longest texts of two slots leave 35 bytes of the arena for the received frames
+    const uint8_t capacities[] = {protocol::scroll::SLOT0_MAX_LENGTH, protocol::scroll::SLOT1_MAX_LENGTH};
+    for (uint8_t slot = 0; slot != 2; ++slot) {
+        std::vector<uint8_t> frame = {5, slot, static_cast<uint8_t>(10 * slot), 10};
+        frame.insert(frame.end(), capacities[slot], 'x');
+        frame.push_back(0);
+        sendCommand(frame);
+    }
+    ASSERT_EQ(35, arena::available() + arena::RECEIVE_RESERVE);
+
+    std::vector<uint8_t> graphics = {6, 100, 40, 0};
+    graphics.insert(graphics.end(), 40, 0x7f);
+    sendCommand(graphics);
+    ASSERT_EQ(0, display::_frameBuffer[100]);
+
+    // the response is kept until the next frame
+    for (int i = 0; i != 2; ++i) {
+        onStart();
+        assertReadIs(crc8ccittUpdate(0, protocol::NO_SPACE_RESPONSE));
+        assertReadIs(protocol::NO_SPACE_RESPONSE);
+    }
+
+    // the text isn't truncated to the space
+    std::vector<uint8_t> text = {4, 20, 20};
+    text.insert(text.end(), 40, 'a');
+    text.push_back(0);
+    sendCommand(text);
+    ASSERT_EQ(0, display::_frameBuffer[100]);
+    onStart();
+    assertReadIs(crc8ccittUpdate(0, protocol::NO_SPACE_RESPONSE));
+    assertReadIs(protocol::NO_SPACE_RESPONSE);
+
+    // the shorter text of the slot frees the space
+    sendCommand({5, 1, 10, 10, 'y', 0});
+    sendCommand(graphics);
+    ASSERT_EQ(0x7f, display::_frameBuffer[100]);
+    ASSERT_EQ(0x7f, display::_frameBuffer[139]);
+    onStart();
+    assertReadIs(crc8ccittUpdate(0, 6));
+    assertReadIs(6);
+
+    display::clear();
+}
+
+static std::vector<uint8_t> readEncoderEvent(const uint8_t numberOfBytes) {
+    std::vector<uint8_t> response(numberOfBytes);
+    onEventReadStart();
+    for (auto &b : response) {
+        onTransmit(&b);
+    }
+    return response;
+}
+
+TEST(I2C, ReadEncoderEvent) {
+    encoder::Event event{};
+    while (encoder::peekEvent(event) != 0) {
+        encoder::popEvent();
+    }
+
+    encoder::_position = 0x1234;
+    encoder::_pushEvent(encoder::EventType::BUTTON_PRESSED, 0x0567);
+
+    // the event is removed only when read completely
+    readEncoderEvent(3);
+
+    const auto response = readEncoderEvent(2 + sizeof(encoder::Event));
+    uint8_t crc = 0;
+    for (size_t i = 1; i < response.size(); ++i) {
+        crc = crc8ccittUpdate(crc, response[i]);
+    }
+    ASSERT_EQ(crc, response[0]);
+    ASSERT_EQ(1, response[1]);
+    ASSERT_EQ(static_cast<uint8_t>(encoder::EventType::BUTTON_PRESSED), response[3]);
+    ASSERT_EQ(0x34, response[4]);
+    ASSERT_EQ(0x12, response[5]);
+    ASSERT_EQ(0x67, response[6]);
+    ASSERT_EQ(0x05, response[7]);
+
+    const auto emptyResponse = readEncoderEvent(4);
+    ASSERT_EQ(0, emptyResponse[1]);
+    ASSERT_EQ(static_cast<uint8_t>(response[2] + 1), emptyResponse[2]);
+    ASSERT_EQ(static_cast<uint8_t>(encoder::EventType::NONE), emptyResponse[3]);
+
+    encoder::_position = 0;
+}
+
+TEST(I2C, GetInputLoad) {
+    sendCommand({15});
+
+    onStart();
+    assertReadIs(212);
+    assertReadIs(15);
+    assertReadIs(100);
+    assertReadIs(0);
+    assertReadIs(2015 & 0xff);
+    assertReadIs(2015 >> 8);
+    assertReadIs(0x45);
+    assertReadIs(0x23);
+    assertReadIs(0x01);
+    assertReadIs(0);
+}
+
+TEST(I2C, GetBusLoad) {
+    sendCommand({16});
+
+    const uint8_t expected[] = {16, 40, 0, 180, 0, 0x34, 0x12, 0, 0};
+    uint8_t crc = 0;
+    for (const uint8_t b : expected) {
+        crc = crc8ccittUpdate(crc, b);
+    }
+
+    onStart();
+    assertReadIs(crc);
+    for (const uint8_t b : expected) {
+        assertReadIs(b);
+    }
+}
+
+TEST(I2C, InvalidCrc) {
+    display::clear();
+
+    // valid frame of WRITE_STATIC_TEXT has CRC 96
+    onStart();
+    for (const uint8_t b : std::initializer_list<uint8_t>{97, 4, 1, 3, 'a', 'b', 'c', 0}) {
+        onReceive(b);
+    }
+    processDataIfAvailable();
+    assertFramebufferIsEmpty();
+
+    onStart();
+    assertReadIs(0);
+    assertReadIs(static_cast<uint8_t>(protocol::Command::NONE));
+
+    // the CRC starts over with every transaction
+    sendCommand({4, 1, 3, 'a', 'b', 'c', 0});
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+}
+
+TEST(I2C, CommandDeferredUntilProcessed) {
+    display::clear();
+
+    onStart();
+    onReceive(96);
+    onReceive(4);
+    onReceive(1);
+    onReceive(3);
+    onReceive('a');
+    onReceive('b');
+    onReceive('c');
+    onReceive(0);
+
+    // not executed in the interrupt
+    assertFramebufferIsEmpty();
+
+    // accepted, the response has to be read again
+    onStart();
+    assertReadIs(244);
+    assertReadIs(protocol::PENDING_RESPONSE);
+
+    // frames written before the pending command is executed are not accepted
+    onStart();
+    onReceive(14);
+    onReceive(2);
+
+    onStart();
+    assertReadIs(243);
+    assertReadIs(protocol::BUSY_RESPONSE);
+
+    processDataIfAvailable();
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+
+    processDataIfAvailable();
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+
+    // the master has to write the rejected frame again, not read the response of the previous one
+    onStart();
+    assertReadIs(243);
+    assertReadIs(protocol::BUSY_RESPONSE);
+
+    onStart();
+    onReceive(14);
+    onReceive(2);
+
+    onStart();
+    assertReadIs(244);
+    assertReadIs(protocol::PENDING_RESPONSE);
+
+    processDataIfAvailable();
+    assertFramebufferIsEmpty();
+
+    onStart();
+    assertReadIs(14);
+    assertReadIs(2);
+}
+
+TEST(I2C, ReceivingPaused) {
+    display::clear();
+
+    // frames written while the arena is used outside the command handlers are dropped
+    ASSERT_TRUE(pauseReceiving());
+    onStart();
+    onReceive(14);
+    onReceive(2);
+    processDataIfAvailable();
+
+    onStart();
+    assertReadIs(243);
+    assertReadIs(protocol::BUSY_RESPONSE);
+
+    resumeReceiving();
+    sendCommand({4, 1, 3, 'a', 'b', 'c', 0});
+    ASSERT_EQ(0x20, display::_frameBuffer[5]);
+
+    // a frame waiting for execution is kept
+    onStart();
+    onReceive(14);
+    onReceive(2);
+    ASSERT_FALSE(pauseReceiving());
+    processDataIfAvailable();
+    assertFramebufferIsEmpty();
+
+    onStart();
+    assertReadIs(14);
+    assertReadIs(2);
 }
 
 TEST(I2C, EndYearOfConstruction) {
@@ -266,6 +804,7 @@ TEST(I2C, EndYearOfConstruction) {
     onReceive(209);
     onReceive(9);
     onReceive(20);
+    processDataIfAvailable();
 
     ASSERT_EQ(20, endYearOfConstruction);
 
@@ -277,6 +816,7 @@ TEST(I2C, EndYearOfConstruction) {
     onReceive(214);
     onReceive(9);
     onReceive(21);
+    processDataIfAvailable();
 
     ASSERT_EQ(21, endYearOfConstruction);
 
@@ -287,9 +827,144 @@ TEST(I2C, EndYearOfConstruction) {
     onStart();
     onReceive(56);
     onReceive(8);
+    processDataIfAvailable();
 
     onStart();
     assertReadIs(195);
     assertReadIs(8);
     assertReadIs(21);
 }
+
+TEST(I2C, AppendChartSample) {
+    sendCommand({2});
+    sendCommand({17, 1, 50, 3, static_cast<uint8_t>(protocol::chart::Style::SPARKLINE), 2});
+    sendCommand({18, 1, 2, 0, 12});
+    ASSERT_EQ(0, display::_frameBuffer[50]);
+    ASSERT_EQ(0b1000000, display::_frameBuffer[51]);
+    ASSERT_EQ(0b0000001, display::_frameBuffer[52]);
+
+    sendCommand({19, 1, 4});
+    ASSERT_EQ(0b1000000, display::_frameBuffer[50]);
+    ASSERT_EQ(0b0000001, display::_frameBuffer[51]);
+    ASSERT_EQ(0b0010000, display::_frameBuffer[52]);
+
+    // NO_VALUE
+    sendCommand({19, 1, 0x80});
+    ASSERT_EQ(0, display::_frameBuffer[52]);
+
+    sendCommand({2});
+}
+
+TEST(I2C, Ticker) {
+    sendCommand({2});
+    sendCommand({20, 1, 10, 4, 30});
+
+    onStart();
+    assertReadIs(crc8ccittUpdate(0, 20));
+    assertReadIs(20);
+
+    sendCommand({21, 1, 'a', 0xc5, 0x82, 0});
+    ASSERT_EQ(4 + 2, display::_scrollingSlots[1].textLength);
+    ASSERT_EQ(display::UNICODE_START_CODE + 7, arena::get(display::_scrollingSlots[1].convertedText)[5]);
+
+    sendCommand({22, 1});
+    const uint8_t freeSpace = protocol::scroll::SLOT1_MAX_LENGTH - 6;
+    onStart();
+    assertReadIs(crc8ccittUpdate(crc8ccittUpdate(0, 22), freeSpace));
+    assertReadIs(22);
+    assertReadIs(freeSpace);
+
+    sendCommand({2});
+}
+
+TEST(I2C, SaveAndShowPage) {
+    sendCommand({2});
+    sendCommand({4, 0, 2, 'o', 'k', 0});
+    sendCommand({23, 2});
+
+    uint8_t response[3];
+    onStart();
+    for (auto &b : response) {
+        onTransmit(&b);
+    }
+    ASSERT_EQ(23, response[1]);
+    ASSERT_GT(response[2], 0);
+    ASSERT_EQ(crc8ccittUpdate(crc8ccittUpdate(0, 23), response[2]), response[0]);
+
+    sendCommand({2});
+    ASSERT_EQ(0, display::_frameBuffer[0]);
+
+    sendCommand({24, 2});
+    ASSERT_EQ(pgm_read_byte(display::Font5x7 + display::COLUMNS_IN_CHARACTER * ('o' - ' ')), display::_frameBuffer[0]);
+
+    sendCommand({2});
+}
+
+TEST(I2C, TextLayerAndOverlay) {
+    sendCommand({2});
+    sendCommand({28, 1, 1, 'x', 0});
+    ASSERT_EQ('x', arena::get(display::_textLayer)[1]);
+    ASSERT_EQ(0, display::_frameBuffer[5]);
+
+    sendCommand({29, static_cast<uint8_t>(protocol::layer::Blending::MASK)});
+    ASSERT_EQ(static_cast<uint8_t>(protocol::layer::Blending::MASK), display::_textLayerBlending);
+
+    sendCommand({30, 10, static_cast<uint8_t>(protocol::layer::Blending::REPLACE), 0, 2, 0x11, 0x22});
+    ASSERT_EQ(10, display::_overlay.columnPosition);
+    ASSERT_EQ(2, arena::size(display::_overlay.columns));
+    ASSERT_EQ(0x22, arena::get(display::_overlay.columns)[1]);
+    ASSERT_EQ(0, display::_overlay.framesLeft);
+
+    sendCommand({30, 0, 0, 0, 0});
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_overlay.columns);
+
+    sendCommand({29, static_cast<uint8_t>(protocol::layer::Blending::OR)});
+    sendCommand({2});
+    ASSERT_EQ(arena::INVALID_HANDLE, display::_textLayer);
+}
+
+TEST(I2C, SetCellAttributes) {
+    sendCommand({2});
+    sendCommand({31, 38, 5, protocol::attribute::INVERSE_FLAG});
+    ASSERT_FALSE(display::_isCellInSet(display::_invertedCells, 37));
+    ASSERT_TRUE(display::_isCellInSet(display::_invertedCells, 38));
+    ASSERT_TRUE(display::_isCellInSet(display::_invertedCells, 39));
+    ASSERT_FALSE(display::_isCellInSet(display::_blinkingCells, 39));
+
+    sendCommand({31, 0, 40, 0});
+    ASSERT_FALSE(display::_isCellInSet(display::_invertedCells, 39));
+    sendCommand({2});
+}
+
+TEST(I2C, StagedTransition) {
+    sendCommand({2});
+    sendCommand({32});
+    sendCommand({4, 0, 1, 'a', 0});
+    ASSERT_TRUE(display::_transition.staging);
+    ASSERT_EQ(0, gridBits(0));
+
+    sendCommand({33, static_cast<uint8_t>(protocol::transition::Style::DISSOLVE), 5});
+    ASSERT_FALSE(display::_transition.staging);
+    ASSERT_TRUE(display::_transition.running);
+    ASSERT_EQ(5 * protocol::transition::DURATION_UNIT, display::_transition.durationFrames);
+
+    // zero duration shows the content at once
+    sendCommand({33, 0, 0});
+    ASSERT_FALSE(display::_transition.running);
+    ASSERT_NE(0, gridBits(0));
+    sendCommand({2});
+}
+
+TEST(I2C, NumberWidget) {
+    sendCommand({2});
+    sendCommand({34, 1, 4, 6, 2, 0, 0xb0, 0x00});
+    ASSERT_EQ(6, display::_numberWidgets[1].width);
+    ASSERT_EQ(display::UNICODE_START_CODE + 18, display::_numberWidgets[1].unit);
+
+    sendCommand({35, 1, 0x2e, 0xfb});
+    ASSERT_EQ(-1234, display::_numberWidgets[1].shownValue);
+
+    sendCommand({36, 1, 0x40, 0x42, 0x0f, 0x00});
+    ASSERT_EQ(1000000, display::_numberWidgets[1].shownValue);
+    sendCommand({2});
+}
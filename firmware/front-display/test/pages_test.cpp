@@ -0,0 +1,113 @@
+#include "pages.hpp"
+#include "display.hpp"
+#include "eeprom.hpp"
+#include "protocol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace octoglow::front_display;
+
+extern uint8_t eepromContent[eeprom::SIZE];
+
+TEST(Pages, SaveAndShow) {
+    display::clear();
+    display::writeStaticText(0, 10, const_cast<char *>("Octoglow"));
+    display::writeScrollingText(1, 20, 5, const_cast<char *>("lorem ipsum dolor"));
+    display::setUpperBarContent(0b10100000000000000101);
+
+    uint8_t frame[display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER];
+    memcpy(frame, display::_frameBuffer, sizeof(frame));
+
+    const uint8_t length = pages::save(2);
+    ASSERT_GT(length, 0);
+    ASSERT_LE(length, pages::PAGE_SIZE);
+    ASSERT_EQ(length, eepromContent[eeprom::PAGE_STORE_ADDRESS + 2 * pages::PAGE_SIZE]);
+
+    display::clear();
+    display::writeStaticText(30, 5, const_cast<char *>("other"));
+
+    ASSERT_TRUE(pages::show(2));
+
+    ASSERT_EQ(0, memcmp(frame, display::_frameBuffer, sizeof(frame)));
+    ASSERT_EQ(0b10100000000000000101u, display::_upperBarBuffer);
+    ASSERT_EQ(17, display::_scrollingSlots[1].textLength);
+    ASSERT_EQ(20, display::_scrollingSlots[1].startPosition);
+    ASSERT_EQ(5, display::_scrollingSlots[1].length);
+    ASSERT_EQ('m', arena::get(display::_scrollingSlots[1].convertedText)[4]);
+
+    display::clear();
+}
+
+TEST(Pages, EmptyAndOversizedPages) {
+    display::clear();
+    display::writeStaticText(0, 3, const_cast<char *>("abc"));
+
+    ASSERT_FALSE(pages::show(0));
+    ASSERT_FALSE(pages::show(protocol::page::NUMBER_OF_PAGES));
+    ASSERT_EQ(0, pages::save(protocol::page::NUMBER_OF_PAGES));
+
+    const uint8_t length = pages::save(0);
+    ASSERT_GT(length, 0);
+
+    // no runs to compress
+    for (uint8_t c = 0; c < display::NUM_OF_CHARACTERS * display::COLUMNS_IN_CHARACTER; ++c) {
+        display::_frameBuffer[c] = c;
+    }
+    ASSERT_EQ(0, pages::save(0));
+
+    // the previous page is left intact
+    ASSERT_TRUE(pages::show(0));
+    for (uint8_t c = 3 * display::COLUMNS_IN_CHARACTER; c < 10 * display::COLUMNS_IN_CHARACTER; ++c) {
+        ASSERT_EQ(0, display::_frameBuffer[c]);
+    }
+
+    // truncated framebuffer leaves the display unchanged
+    eepromContent[eeprom::PAGE_STORE_ADDRESS] = 8;
+    display::writeStaticText(0, 1, const_cast<char *>("x"));
+    const uint8_t firstColumn = display::_frameBuffer[0];
+    ASSERT_FALSE(pages::show(0));
+    ASSERT_EQ(firstColumn, display::_frameBuffer[0]);
+
+    display::clear();
+}
+
+TEST(Pages, Rotation) {
+    display::clear();
+    display::writeStaticText(0, 1, const_cast<char *>("A"));
+    pages::save(0);
+    display::clear();
+    display::writeStaticText(0, 1, const_cast<char *>("B"));
+    pages::save(1);
+    display::clear();
+
+    uint8_t columnOfA[display::COLUMNS_IN_CHARACTER];
+    uint8_t columnOfB[display::COLUMNS_IN_CHARACTER];
+
+    const uint8_t rotation[] = {0, 1, 1, 2};
+    pages::setRotation(2, rotation);
+    memcpy(columnOfA, display::_frameBuffer, sizeof(columnOfA));
+    ASSERT_NE(0, columnOfA[0]);
+
+    display::_frameTicks = display::_frameTicks + 99;
+    pages::pool();
+    ASSERT_EQ(0, memcmp(columnOfA, display::_frameBuffer, sizeof(columnOfA)));
+
+    display::_frameTicks = display::_frameTicks + 1;
+    pages::pool();
+    memcpy(columnOfB, display::_frameBuffer, sizeof(columnOfB));
+    ASSERT_NE(0, memcmp(columnOfA, columnOfB, sizeof(columnOfA)));
+
+    for (uint8_t i = 0; i < 2; ++i) {
+        display::_frameTicks = display::_frameTicks + 100;
+        pages::pool();
+    }
+    ASSERT_EQ(0, memcmp(columnOfA, display::_frameBuffer, sizeof(columnOfA)));
+
+    pages::setRotation(0, nullptr);
+    display::clear();
+    display::_frameTicks = display::_frameTicks + 250;
+    pages::pool();
+    ASSERT_EQ(0, display::_frameBuffer[0]);
+}
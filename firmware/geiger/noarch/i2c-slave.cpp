@@ -2,17 +2,28 @@
 #include "magiceye.hpp"
 #include "inverter.hpp"
 #include "geiger-counter.hpp"
+#include "framing.hpp"
 
 using namespace octoglow::geiger::protocol;
 using namespace octoglow::geiger;
+using namespace octoglow;
 
 constexpr uint8_t BUFFER_SIZE = 16;
 
-static uint8_t volatile buffer[BUFFER_SIZE];
+/*
+ * Written by the interrupt until the stop condition, then owned by the main loop until the response is placed in it.
+ * Not volatile, so the handlers get a plain pointer; the handover is ordered by framing::handOverBuffer().
+ */
+static uint8_t buffer[BUFFER_SIZE];
 static volatile uint8_t bytesProcessed = 0;
 static volatile uint8_t numberOfBytesToTransmit = 0;
 static volatile bool bufferLoadedWithData = false;
 
+/*
+ * CRC of the bytes received after the CRC byte, updated with every byte, so the frame is validated in constant time.
+ */
+static volatile uint8_t receivedCrc = 0;
+
 static_assert(sizeof(buffer) >= 4, "buffer has to have at least 4 bytes");
 static_assert(sizeof(buffer) >= sizeof(GeigerState) + 2, "buffer has to contain whole GeigerState structure");
 static_assert(sizeof(buffer) >= sizeof(DeviceState) + 2, "buffer has to contain whole DeviceState structure");
@@ -29,30 +40,12 @@ void i2c::onTransmit(uint8_t volatile *value) {
 
 void i2c::onStart() {
     bytesProcessed = 0;
-}
-
-__attribute__((optimize("O3"), hot))
-static inline uint8_t crc8ccittUpdate(const uint8_t inCrc, const uint8_t inData) {
-    uint8_t data = inCrc ^ inData;
-    for (uint8_t i = 0; i < 8; i++) {
-        if ((data & 0x80) != 0) {
-            data <<= 1;
-            data ^= 0x07;
-        } else {
-            data <<= 1;
-        }
-    }
-    return data;
+    receivedCrc = 0;
 }
 
 __attribute__((optimize("O3"), hot))
 static inline bool checkCrc8fails() {
-    uint8_t calculatedCrcValue = 0;
-    for (uint8_t i = 1; i < bytesProcessed; i++) {
-        calculatedCrcValue = crc8ccittUpdate(calculatedCrcValue, buffer[i]);
-    }
-
-    if (buffer[0] != calculatedCrcValue) {
+    if (buffer[0] != receivedCrc) {
         buffer[0] = 0;
         buffer[1] = static_cast<uint8_t>(Command::NONE);
         return true;
@@ -60,38 +53,72 @@ static inline bool checkCrc8fails() {
     return false;
 }
 
-__attribute__((optimize("O3"), hot))
-static inline void setCrcForSimpleCommand() {
-    numberOfBytesToTransmit = 2;
-    buffer[0] = crc8ccittUpdate(0, buffer[1]);
+static inline void copyState(uint8_t *const response, const void volatile *const src, const uint8_t size) {
+    for (uint8_t i = 0; i != size; ++i) {
+        response[i] = *(static_cast<const uint8_t volatile *>(src) + i);
+    }
 }
 
-__attribute__((optimize("O3"), hot))
-static inline void setCrcForComplexCommand(const uint8_t payloadLength) {
-    uint8_t crcValue = 0;
-    for (uint8_t i = 1; i < payloadLength + 2; ++i) {
-        crcValue = crc8ccittUpdate(crcValue, buffer[i]);
-    }
-    buffer[0] = crcValue;
-    numberOfBytesToTransmit = payloadLength + 2;
+static void getDeviceState(const uint8_t *, uint8_t *const response) {
+    copyState(response, &i2c::hd::getDeviceState(), sizeof(DeviceState));
 }
 
-static inline void fillBuffer(const void volatile *src, const uint8_t size) {
-    for (uint8_t i = 0; i != size; ++i) {
-        buffer[i + 2] = *(static_cast<const uint8_t volatile *>(src) + i);
-    }
+static void getGeigerState(const uint8_t *, uint8_t *const response) {
+    geiger_counter::updateGeigerState();
+    copyState(response, &geiger_counter::geigerState, sizeof(GeigerState));
+    geiger_counter::geigerState.hasNewCycleStarted = false;
+}
+
+static void setGeigerConfiguration(const uint8_t *const frame, uint8_t *) {
+    geiger_counter::configure(*reinterpret_cast<const GeigerConfiguration *>(frame + 1));
 }
 
+static void cleanGeigerState(const uint8_t *, uint8_t *) {
+    geiger_counter::resetCounters();
+}
+
+static void setEyeConfiguration(const uint8_t *const frame, uint8_t *) {
+    magiceye::configure(*reinterpret_cast<const EyeConfiguration *>(frame + 1));
+}
+
+static void setEyeDisplayValue(const uint8_t *const frame, uint8_t *) {
+    magiceye::setDacOutputValue(frame[1]);
+}
+
+static void setBrightness(const uint8_t *const frame, uint8_t *) {
+    inverter::setBrightness(frame[1]);
+}
+
+/**
+ * Commands with response length 0 respond only with the command number.
+ */
+static constexpr framing::CommandDescriptor COMMANDS[] FRAMING_TABLE = {
+        framing::fixed(Command::GET_DEVICE_STATE, 1, getDeviceState, sizeof(DeviceState)),
+        framing::fixed(Command::GET_GEIGER_STATE, 1, getGeigerState, sizeof(GeigerState)),
+        framing::fixed(Command::SET_GEIGER_CONFIGURATION, 1 + sizeof(GeigerConfiguration), setGeigerConfiguration),
+        framing::fixed(Command::CLEAN_GEIGER_STATE, 1, cleanGeigerState),
+        framing::fixed(Command::SET_EYE_CONFIGURATION, 1 + sizeof(EyeConfiguration), setEyeConfiguration),
+        framing::fixed(Command::SET_EYE_DISPLAY_VALUE, 2, setEyeDisplayValue),
+        framing::fixed(Command::SET_BRIGHTNESS, 2, setBrightness),
+};
+
+static_assert(framing::isValidTable(COMMANDS), "commands have to be listed in the order of their numbers");
+
 void i2c::onReceive(const uint8_t value) {
     if (bytesProcessed == sizeof(buffer) - 1) {
         return;
     }
 
+    if (bytesProcessed != 0) {
+        receivedCrc = framing::crc8ccittUpdate(receivedCrc, value);
+    }
+
     buffer[bytesProcessed] = value;
     ++bytesProcessed;
 }
 
 void i2c::onStop() {
+    framing::handOverBuffer();
     bufferLoadedWithData = true;
 }
 
@@ -99,65 +126,21 @@ void i2c::processDataIfAvailable() {
     if (!bufferLoadedWithData) {
         return;
     }
+    bufferLoadedWithData = false;
+    framing::handOverBuffer();
 
-    const auto cmd = static_cast<Command>(buffer[1]);
-
-    if (bytesProcessed == 2) {
-        // 1 byte command
-        if (cmd == Command::CLEAN_GEIGER_STATE) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            geiger_counter::resetCounters();
-            setCrcForSimpleCommand();
-        } else if (cmd == Command::GET_GEIGER_STATE) {
-            //  setClockToHigh();
-            if (checkCrc8fails()) {
-                //setClockToLow();
-                return;
-            }
-            geiger_counter::updateGeigerState();
-            fillBuffer(&geiger_counter::geigerState, sizeof(GeigerState));
-            setCrcForComplexCommand(sizeof(GeigerState));
-            geiger_counter::geigerState.hasNewCycleStarted = false;
-        } else if (cmd == Command::GET_DEVICE_STATE) {
-            //  setClockToHigh();
-            if (checkCrc8fails()) {
-                //  setClockToLow();
-                return;
-            }
-            fillBuffer(&hd::getDeviceState(), sizeof(DeviceState));
-            setCrcForComplexCommand(sizeof(DeviceState));
-        }
-    } else if (bytesProcessed == 3) {
-        if (cmd == Command::SET_EYE_DISPLAY_VALUE) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            magiceye::setDacOutputValue(buffer[2]);
-            setCrcForSimpleCommand();
-        } else if (cmd == Command::SET_BRIGHTNESS) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            inverter::setBrightness(buffer[2]);
-            setCrcForSimpleCommand();
-        }
-    } else if (bytesProcessed == 4) {
-        if (cmd == Command::SET_GEIGER_CONFIGURATION) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            geiger_counter::configure(*reinterpret_cast<volatile GeigerConfiguration *>(buffer + 2));
-            setCrcForSimpleCommand();
-        } else if (cmd == Command::SET_EYE_CONFIGURATION) {
-            if (checkCrc8fails()) {
-                return;
-            }
-            magiceye::configure(*reinterpret_cast<volatile EyeConfiguration *>(buffer + 2));
-            setCrcForSimpleCommand();
-        }
+    framing::CommandDescriptor descriptor{};
+
+    // crc is at buffer 0, command is at 1
+    if (bytesProcessed < 2
+        or not framing::findCommand(COMMANDS, buffer[1], descriptor)
+        or not framing::isFrameComplete(descriptor, &buffer[1], bytesProcessed - 1)
+        or checkCrc8fails()) {
+        return;
     }
 
-    bufferLoadedWithData = false;
+    descriptor.handler(&buffer[1], &buffer[2]);
+    const uint8_t responseSize = framing::sealResponse(buffer, descriptor.responseLength);
+    framing::handOverBuffer();
+    numberOfBytesToTransmit = responseSize;
 }
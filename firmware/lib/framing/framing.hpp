@@ -0,0 +1,228 @@
+#pragma once
+
+/*
+ * I2C command framing shared by all boards.
+ *
+ * Every frame sent by the master is the CRC-8-CCITT of the rest of the frame, the command number and its payload.
+ * The response is the CRC, the command number and the response payload. Each board declares its commands once,
+ * in a table of CommandDescriptor indexed by the command number. The frame length checking, the dispatch and
+ * the response CRC all work from the table.
+ */
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+/**
+ * Place of the command table. The table is read one descriptor at a time, so on AVR it is kept in flash.
+ */
+#define FRAMING_TABLE PROGMEM
+#else
+#define FRAMING_TABLE
+#endif
+
+namespace octoglow::framing {
+
+    enum class Framing : uint8_t {
+        /**
+         * Frame has exactly CommandDescriptor::length bytes.
+         */
+        FIXED,
+        /**
+         * Frame ends with the first zero byte from CommandDescriptor::length - 1 on. If the byte at fieldIndex
+         * has any of the fieldMask bits set, an optional byte precedes the terminated data.
+         */
+        TERMINATED,
+        /**
+         * Frame has CommandDescriptor::length bytes followed by the number of bytes stored at fieldIndex.
+         */
+        COUNTED,
+    };
+
+    /**
+     * Executes the command. The frame starts with the command number, it doesn't contain the CRC.
+     * The response payload is written to response. Both can point to the same buffer, so the frame can't be
+     * read once the response has been written.
+     */
+    using Handler = void (*)(const uint8_t *frame, uint8_t *response);
+
+    struct CommandDescriptor {
+        uint8_t command;
+        Framing framing;
+        uint8_t length;
+        uint8_t fieldIndex;
+        uint8_t fieldMask;
+        uint8_t responseLength;
+        Handler handler;
+    };
+
+    /**
+     * @param length number of bytes of the frame, including the command number
+     * @param responseLength length of the response payload, 0 if only the command number is sent back
+     */
+    template<typename C>
+    constexpr CommandDescriptor fixed(const C command, const uint8_t length, const Handler handler,
+                                      const uint8_t responseLength = 0) {
+        return {static_cast<uint8_t>(command), Framing::FIXED, length, 0, 0, responseLength, handler};
+    }
+
+    /**
+     * @param minimumLength length of the shortest frame, including the command number and the terminating zero
+     */
+    template<typename C>
+    constexpr CommandDescriptor terminated(const C command, const uint8_t minimumLength, const Handler handler,
+                                           const uint8_t flagIndex = 0, const uint8_t optionalFieldFlag = 0) {
+        return {static_cast<uint8_t>(command), Framing::TERMINATED, minimumLength, flagIndex, optionalFieldFlag, 0,
+                handler};
+    }
+
+    /**
+     * @param countIndex index of the byte holding the number of the following data bytes
+     * @param headerLength length of the frame without the counted data, including the command number
+     */
+    template<typename C>
+    constexpr CommandDescriptor counted(const C command, const uint8_t countIndex, const uint8_t headerLength,
+                                        const Handler handler) {
+        return {static_cast<uint8_t>(command), Framing::COUNTED, headerLength, countIndex, 0, 0, handler};
+    }
+
+    /**
+     * Checks if the table can be indexed by the command number: the first command is 1 and there are no gaps.
+     */
+    template<uint8_t N>
+    constexpr bool isValidTable(const CommandDescriptor (&table)[N]) {
+        for (uint8_t i = 0; i != N; ++i) {
+            if (table[i].command != i + 1 or table[i].handler == nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Copies the descriptor of the command out of the table.
+     * @return false if the command is not in the table
+     */
+    template<uint8_t N>
+    inline bool findCommand(const CommandDescriptor (&table)[N], const uint8_t command,
+                            CommandDescriptor &descriptor) {
+        if (command == 0 or command > N) {
+            return false;
+        }
+#ifdef __AVR__
+        memcpy_P(&descriptor, &table[command - 1], sizeof(CommandDescriptor));
+#else
+        descriptor = table[command - 1];
+#endif
+        return true;
+    }
+
+    /**
+     * Index of the terminated data in the frame of the TERMINATED command, after the optional byte if it is present.
+     * The bytes up to the index have to be received already.
+     */
+    inline uint8_t terminatedDataStart(const CommandDescriptor &descriptor, const uint8_t *const frame) {
+        return descriptor.length - 1 + ((frame[descriptor.fieldIndex] & descriptor.fieldMask) ? 1 : 0);
+    }
+
+    /**
+     * Checks if the last received byte completes the frame.
+     * @param frame command number followed by its payload, without the CRC
+     * @param length number of bytes of the frame received so far
+     */
+    inline bool isFrameComplete(const CommandDescriptor &descriptor, const uint8_t *const frame,
+                                const uint8_t length) {
+        switch (descriptor.framing) {
+            case Framing::FIXED:
+                return length == descriptor.length;
+            case Framing::TERMINATED:
+                return length > descriptor.fieldIndex
+                       and frame[length - 1] == 0
+                       and length > terminatedDataStart(descriptor, frame);
+            case Framing::COUNTED:
+                return length > descriptor.fieldIndex
+                       and length == descriptor.length + frame[descriptor.fieldIndex];
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @return length of the frame at the beginning of the data or 0 if the data doesn't contain a complete frame
+     */
+    inline uint8_t frameLength(const CommandDescriptor &descriptor, const uint8_t *const frame,
+                               const uint8_t dataLength) {
+        for (uint8_t length = 1; length <= dataLength; ++length) {
+            if (isFrameComplete(descriptor, frame, length)) {
+                return length;
+            }
+        }
+        return 0;
+    }
+
+#ifdef __AVR__
+
+    /**
+     * AVR boards are short of flash, the avr-libc function is smaller than the table.
+     */
+    inline uint8_t crc8ccittUpdate(const uint8_t inCrc, const uint8_t inData) {
+        return _crc8_ccitt_update(inCrc, inData);
+    }
+
+#else
+
+    /**
+     * CRC-8-CCITT of every byte value, generated at compile time. The bitwise calculation takes 8 iterations per byte.
+     */
+    struct Crc8Table {
+        uint8_t values[256];
+
+        constexpr Crc8Table() : values() {
+            for (uint16_t i = 0; i != 256; ++i) {
+                uint8_t data = i;
+                for (uint8_t b = 0; b != 8; ++b) {
+                    data = (data & 0x80) ? (data << 1) ^ 0x07 : data << 1;
+                }
+                values[i] = data;
+            }
+        }
+    };
+
+    inline constexpr Crc8Table CRC8_TABLE;
+
+    static_assert(CRC8_TABLE.values[1] == 0x07 and CRC8_TABLE.values[0xff] == 0xf3, "invalid CRC table");
+
+    inline uint8_t crc8ccittUpdate(const uint8_t inCrc, const uint8_t inData) {
+        return CRC8_TABLE.values[inCrc ^ inData];
+    }
+
+#endif
+
+    inline uint8_t crc8(const uint8_t *const data, const uint8_t length) {
+        uint8_t crc = 0;
+        for (uint8_t i = 0; i != length; ++i) {
+            crc = crc8ccittUpdate(crc, data[i]);
+        }
+        return crc;
+    }
+
+    /**
+     * Compiler memory barrier placed where the frame buffer changes hands between the interrupt and the main loop.
+     * Only the flag guarding the buffer is volatile, without the barrier the buffer accesses could be moved
+     * across the flag update. A single byte flag is written atomically, so no interrupt blocking is needed.
+     */
+    inline void handOverBuffer() {
+        __asm__ __volatile__("" ::: "memory");
+    }
+
+    /**
+     * Puts the CRC in front of the response, which holds the command number at index 1 followed by the payload.
+     * @return number of bytes of the response
+     */
+    inline uint8_t sealResponse(uint8_t *const response, const uint8_t payloadLength) {
+        response[0] = crc8(response + 1, payloadLength + 1);
+        return payloadLength + 2;
+    }
+}
@@ -14,6 +14,11 @@ import kotlin.math.roundToInt
 import kotlin.time.Clock
 import kotlin.time.ExperimentalTime
 
+/**
+ * Scrolling slots with the capacities of their texts, in UTF-8 bytes. The texts of all slots share the memory
+ * of the display with the received commands, so the longest texts don't fit all at once.
+ * FrontDisplay.setScrollingText() frees the old text of the slot if the new one doesn't fit next to it.
+ */
 enum class Slot(val capacity: Int) {
     SLOT0(148), // should be 150, but probably firmware bug
     SLOT1(68),
@@ -115,7 +120,14 @@ interface FrontDisplay {
         require(text.isNotEmpty()) { "text length has to be at least 1" }
         require(lastPosition < 40) { "end of the string cannot exceed position 39, but has length ${textBytes.size} and position $position, which sums to $lastPosition, text: $text" }
 
-        setText(textBytes, intArrayOf(5, slot.ordinal, position, length))
+        val header = intArrayOf(5, slot.ordinal, position, length)
+        try {
+            setText(textBytes, header)
+        } catch (e: NoSpaceException) {
+            // the new text is received while the old one still takes the memory, blank the window to free it
+            setText(" ".repeat(length).toByteArray(StandardCharsets.UTF_8), header)
+            setText(textBytes, header)
+        }
     }
 }
 
@@ -27,6 +27,8 @@ interface Hardware : AutoCloseable {
 
     suspend fun doWrite(i2cAddress: Int, writeData: IntArray)
 
+    suspend fun doRead(i2cAddress: Int, bytesToRead: Int): IntArray
+
     suspend fun doTransaction(
         i2cAddress: Int,
         writeData: IntArray,
@@ -163,6 +165,19 @@ class HardwareReal(
         }
     }
 
+    override suspend fun doRead(i2cAddress: Int, bytesToRead: Int): IntArray = withContext(Dispatchers.IO) {
+        require(bytesToRead in 1..100)
+        try {
+            busMutex.withLock {
+                bus.selectSlave(i2cAddress)
+                bus.read(readI2cBuffer, bytesToRead)
+                IntArray(bytesToRead) { readI2cBuffer.get(it) }
+            }
+        } catch (e: Exception) {
+            throw handleI2cException(e)
+        }
+    }
+
     override suspend fun doTransaction(
         i2cAddress: Int,
         writeData: IntArray,
@@ -5,6 +5,12 @@ import io.github.oshai.kotlinlogging.KLogger
 import kotlin.time.Duration
 import kotlin.time.Duration.Companion.milliseconds
 
+/**
+ * The device refused the command, because it doesn't fit its free memory. Writing it again helps only
+ * after the memory is freed.
+ */
+class NoSpaceException(message: String) : IllegalStateException(message)
+
 interface I2cDevice {
     val i2cAddress: Int
 
@@ -48,6 +54,24 @@ abstract class CustomI2cDevice(
 
         private const val NUMBER_OF_REPETITIONS = 5
 
+        /**
+         * Sent instead of the command number if the command was accepted, but not executed yet. The response
+         * has to be read again, writing the command again would execute it twice.
+         */
+        internal const val PENDING_RESPONSE = 0xfe
+
+        /**
+         * Sent instead of the command number if the command was not accepted, because the previous one
+         * was not executed yet. The command has to be written again.
+         */
+        internal const val BUSY_RESPONSE = 0xff
+
+        /**
+         * Sent instead of the command number if the command was not accepted, because it doesn't fit the free memory
+         * of the device.
+         */
+        internal const val NO_SPACE_RESPONSE = 0xfd
+
         internal fun calculateCcittCrc8(data: IntArray, range: ClosedRange<Int>): Int {
             var crcValue = 0x00
 
@@ -74,6 +98,14 @@ abstract class CustomI2cDevice(
             return buff
         }
 
+        internal fun isPendingResponse(respBuff: IntArray): Boolean = respBuff.size >= 2
+                && respBuff[1] == PENDING_RESPONSE
+                && calculateCcittCrc8(respBuff, 1..<respBuff.size) == respBuff[0]
+
+        internal fun isNoSpaceResponse(respBuff: IntArray): Boolean = respBuff.size >= 2
+                && respBuff[1] == NO_SPACE_RESPONSE
+                && calculateCcittCrc8(respBuff, 1..<respBuff.size) == respBuff[0]
+
         internal fun verifyResponse(reqBuff: IntArray, respBuff: IntArray) {
             try {
                 require(respBuff.size >= 2) { "response has to be at least 2 bytes" }
@@ -89,18 +121,51 @@ abstract class CustomI2cDevice(
         }
     }
 
+    /**
+     * Writes the command and reads the response. Once the device has accepted the command, only the response
+     * is read on the following tries, so the command is never executed twice. The command refused for lack
+     * of memory is not tried again, NoSpaceException is thrown instead.
+     */
+    private suspend fun executeCommand(
+        operationDescription: String,
+        request: IntArray,
+        bytesToRead: Int,
+    ): IntArray {
+        var accepted = false
+
+        val response = trySeveralTimes(NUMBER_OF_REPETITIONS, logger, operationDescription) {
+            val response = if (accepted) {
+                hardware.doRead(i2cAddress, bytesToRead)
+            } else {
+                hardware.doTransaction(i2cAddress, request, bytesToRead, delayBetweenWriteAndRead)
+            }
+
+            if (isNoSpaceResponse(response)) {
+                return@trySeveralTimes response
+            } else if (isPendingResponse(response)) {
+                accepted = true
+            } else if (response.size >= 2 && response[1] == BUSY_RESPONSE) {
+                accepted = false
+            }
+
+            verifyResponse(request, response)
+            response
+        }
+
+        if (isNoSpaceResponse(response)) {
+            throw NoSpaceException("operation '$operationDescription' refused, the device has no free memory for request ${request.contentToString()}")
+        }
+
+        return response
+    }
+
     suspend fun sendCommand(
         operationDescription: String,
         vararg cmd: Int,
     ) {
         val request = createCommandWithCrc(*cmd)
-
-        return trySeveralTimes(NUMBER_OF_REPETITIONS, logger, operationDescription) {
-            val returned = hardware.doTransaction(i2cAddress, request, 2, delayBetweenWriteAndRead)
-
-            check(returned.size == 2)
-            verifyResponse(request, returned)
-        }
+        val returned = executeCommand(operationDescription, request, 2)
+        check(returned.size == 2)
     }
 
     suspend fun sendCommandAndReadData(
@@ -111,10 +176,6 @@ abstract class CustomI2cDevice(
         require(noBytesToRead in 0..20) { "invalid value for number of bytes to read" }
         val commandWithCrc = createCommandWithCrc(*cmd)
 
-        return trySeveralTimes(NUMBER_OF_REPETITIONS, logger, operationDescription) {
-            val readBuffer = hardware.doTransaction(i2cAddress, commandWithCrc, noBytesToRead, delayBetweenWriteAndRead)
-            verifyResponse(commandWithCrc, readBuffer)
-            readBuffer
-        }
+        return executeCommand(operationDescription, commandWithCrc, noBytesToRead)
     }
 }
\ No newline at end of file
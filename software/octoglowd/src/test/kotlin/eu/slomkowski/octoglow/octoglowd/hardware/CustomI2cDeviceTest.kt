@@ -1,15 +1,29 @@
 package eu.slomkowski.octoglow.octoglowd.hardware
 
+import eu.slomkowski.octoglow.octoglowd.hardware.CustomI2cDevice.Companion.BUSY_RESPONSE
+import eu.slomkowski.octoglow.octoglowd.hardware.CustomI2cDevice.Companion.NO_SPACE_RESPONSE
+import eu.slomkowski.octoglow.octoglowd.hardware.CustomI2cDevice.Companion.PENDING_RESPONSE
 import eu.slomkowski.octoglow.octoglowd.hardware.CustomI2cDevice.Companion.calculateCcittCrc8
 import eu.slomkowski.octoglow.octoglowd.hardware.CustomI2cDevice.Companion.createCommandWithCrc
 import io.github.oshai.kotlinlogging.KotlinLogging
+import io.mockk.coEvery
+import io.mockk.coVerify
+import io.mockk.mockk
+import kotlinx.coroutines.runBlocking
 import org.assertj.core.api.Assertions.assertThat
+import org.assertj.core.api.Assertions.assertThatThrownBy
 import org.junit.jupiter.api.Test
 
 class CustomI2cDeviceTest {
 
     private val logger = KotlinLogging.logger {}
 
+    private class TestDevice(hardware: Hardware) : CustomI2cDevice(hardware, KotlinLogging.logger {}, 0x14) {
+        override suspend fun initDevice() = Unit
+
+        override suspend fun closeDevice() = Unit
+    }
+
     @Test
     fun testCalculateCrc8() {
         val buff = intArrayOf(251, 4, 2, 137, 20, 104, 132, 19)
@@ -52,4 +66,43 @@ class CustomI2cDeviceTest {
         val result = createCommandWithCrc(*buff)
         assertThat(result).isEqualTo(intArrayOf(160, 1, 49, 50, 51, 52))
     }
-}
\ No newline at end of file
+
+    @Test
+    fun `pending command is read again, not written again`(): Unit = runBlocking {
+        val hardware = mockk<Hardware>()
+        val response = createCommandWithCrc(2)
+
+        coEvery { hardware.doTransaction(0x14, any(), 2, any()) } returns createCommandWithCrc(PENDING_RESPONSE)
+        coEvery { hardware.doRead(0x14, 2) } returnsMany listOf(createCommandWithCrc(PENDING_RESPONSE), response)
+
+        TestDevice(hardware).sendCommand("clear display", 2)
+
+        coVerify(exactly = 1) { hardware.doTransaction(0x14, any(), 2, any()) }
+        coVerify(exactly = 2) { hardware.doRead(0x14, 2) }
+    }
+
+    @Test
+    fun `busy command is written again`(): Unit = runBlocking {
+        val hardware = mockk<Hardware>()
+        val response = createCommandWithCrc(2)
+
+        coEvery { hardware.doTransaction(0x14, any(), 2, any()) } returnsMany listOf(createCommandWithCrc(BUSY_RESPONSE), response)
+
+        TestDevice(hardware).sendCommand("clear display", 2)
+
+        coVerify(exactly = 2) { hardware.doTransaction(0x14, any(), 2, any()) }
+        coVerify(exactly = 0) { hardware.doRead(any(), any()) }
+    }
+
+    @Test
+    fun `command refused for lack of memory is not written again`(): Unit = runBlocking {
+        val hardware = mockk<Hardware>()
+
+        coEvery { hardware.doTransaction(0x14, any(), 2, any()) } returns createCommandWithCrc(NO_SPACE_RESPONSE)
+
+        assertThatThrownBy { runBlocking { TestDevice(hardware).sendCommand("draw graphics", 6) } }
+            .isInstanceOf(NoSpaceException::class.java)
+
+        coVerify(exactly = 1) { hardware.doTransaction(0x14, any(), 2, any()) }
+    }
+}
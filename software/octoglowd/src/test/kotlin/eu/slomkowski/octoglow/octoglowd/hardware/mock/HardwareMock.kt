@@ -35,6 +35,10 @@ class HardwareMock : Hardware {
         TODO("Not yet implemented")
     }
 
+    override suspend fun doRead(i2cAddress: Int, bytesToRead: Int): IntArray {
+        TODO("Not yet implemented")
+    }
+
     override suspend fun doTransaction(i2cAddress: Int, writeData: IntArray, bytesToRead: Int, delayBetweenWriteAndRead: Duration): IntArray {
         TODO("Not yet implemented")
     }